@@ -0,0 +1,420 @@
+#include "textwolf.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+//build gcc
+//compile: g++ -c -o textwolfbench.o -I../include/ -Wall -O4 textwolfbench.cpp
+//link: g++ -lc -o textwolfbench textwolfbench.o
+//build windows
+//compile: cl.exe /wd4996 /Ob2 /O2 /EHsc /MT /W4 /nologo /I..\include /D "WIN32" /D "_WINDOWS" /Fo"textwolfbench.obj" textwolfbench.cpp
+//link: link.exe /out:.\textwolfbench textwolfbench.obj
+//usage: textwolfbench [-s <corpus size in KB>] [-r <number of repetitions>]
+//	Prints the results as JSON to stdout. The events of a result are the XML elements of the document as returned by XMLScanner::nextItem(), so that events_per_s of the benchmarks on the same document compare. The corpora are generated with a fixed seed, so that every run and platform measures the same input. The best time out of the repetitions is reported (CPU time).
+
+using namespace textwolf;
+
+/// \class Random
+/// \brief Deterministic pseudo random number generator (linear congruential, same sequence on every platform)
+class Random
+{
+public:
+	explicit Random( unsigned int seed)
+		:m_state(seed){}
+
+	unsigned int get( unsigned int max)
+	{
+		m_state = m_state * 1103515245U + 12345U;
+		return ((m_state >> 16) & 0x7FFF) % max;
+	}
+
+	const char* word()
+	{
+		static const char* ar[] = {"lorem","ipsum","dolor","sit","amet","consectetur","adipiscing","elit","sed","do","eiusmod","tempor","\xC3\xA9t\xC3\xA9","gr\xC3\xBC\xC3\x9F","na\xC3\xAFve","caf\xC3\xA9"};
+		return ar[ get( sizeof(ar)/sizeof(ar[0]))];
+	}
+
+private:
+	unsigned int m_state;
+};
+
+/// \brief Corpus with many attributes per element and short values
+static std::string corpusAttributes( std::size_t size)
+{
+	Random rnd( 1);
+	std::ostringstream out;
+	out << "<doc>\n";
+	for (unsigned int ii=0; (std::size_t)out.tellp() < size; ++ii)
+	{
+		out << "<rec id='" << ii << "' name=\"" << rnd.word() << "\" type='" << rnd.get( 100) << "'";
+		unsigned int nofattr = 2 + rnd.get( 6);
+		for (unsigned int ai=0; ai<nofattr; ++ai)
+		{
+			out << " a" << ai << "=\"" << rnd.word() << "\"";
+		}
+		out << "/>\n";
+	}
+	out << "</doc>\n";
+	return out.str();
+}
+
+/// \brief Corpus with long text content
+static std::string corpusContent( std::size_t size)
+{
+	Random rnd( 2);
+	std::ostringstream out;
+	out << "<doc>\n";
+	while ((std::size_t)out.tellp() < size)
+	{
+		out << "<p>";
+		unsigned int nofwords = 50 + rnd.get( 200);
+		for (unsigned int wi=0; wi<nofwords; ++wi)
+		{
+			out << rnd.word() << ((wi % 13 == 12) ? ".\n" : " ");
+		}
+		out << "</p>\n";
+	}
+	out << "</doc>\n";
+	return out.str();
+}
+
+/// \brief Corpus with deeply nested elements
+static std::string corpusNesting( std::size_t size)
+{
+	enum {Depth=64};
+	Random rnd( 3);
+	std::ostringstream out;
+	out << "<doc>\n";
+	while ((std::size_t)out.tellp() < size)
+	{
+		unsigned int depth = Depth/2 + rnd.get( Depth/2);
+		unsigned int di;
+		for (di=0; di<depth; ++di) out << "<n" << di << ">";
+		out << rnd.word();
+		for (di=depth; di>0; --di) out << "</n" << (di-1) << ">";
+		out << "\n";
+	}
+	out << "</doc>\n";
+	return out.str();
+}
+
+/// \brief Corpus with content and attributes full of character entities
+static std::string corpusEntities( std::size_t size)
+{
+	static const char* entity[] = {"&amp;","&lt;","&gt;","&quot;","&apos;","&#65;","&#xE9;","&#252;","&#x20AC;"};
+	Random rnd( 4);
+	std::ostringstream out;
+	out << "<doc>\n";
+	while ((std::size_t)out.tellp() < size)
+	{
+		out << "<e v='" << entity[ rnd.get( 9)] << rnd.word() << entity[ rnd.get( 9)] << "'>";
+		unsigned int nofwords = 10 + rnd.get( 20);
+		for (unsigned int wi=0; wi<nofwords; ++wi)
+		{
+			out << rnd.word() << entity[ rnd.get( 9)];
+		}
+		out << "</e>\n";
+	}
+	out << "</doc>\n";
+	return out.str();
+}
+
+/// \brief Convert an UTF-8 document to another character set encoding
+template <class CharSet>
+static std::string encode( const std::string& doc)
+{
+	std::string rt;
+	CharSet charset;
+	TextScanner<CStringIterator,charset::UTF8> ts( CStringIterator( doc.c_str(), doc.size()));
+	UChar ch;
+	while ((ch = ts.chr()) != 0)
+	{
+		charset.print( ch, rt);
+		++ts;
+	}
+	return rt;
+}
+
+/// \brief Current CPU time in seconds
+static double cputime()
+{
+	return (double)std::clock() / CLOCKS_PER_SEC;
+}
+
+/// \class Measure
+/// \brief Result of one benchmark
+struct Measure
+{
+	std::size_t bytes;		///< number of bytes of the document processed (of the document printed for the printer)
+	std::size_t events;		///< number of events of the document processed, i.e. of the XML elements returned by XMLScanner::nextItem() without the final Exit, the same for all benchmarks on a document
+	double seconds;			///< best time needed
+};
+
+/// \brief Scan a document with XMLScanner::nextItem()
+/// \return the number of events of the document (see Measure::events)
+template <class CharSet>
+static std::size_t runScanner( const std::string& doc)
+{
+	typedef XMLScanner<SrcIterator,CharSet,charset::UTF8,std::string> Scanner;
+	Scanner xs( SrcIterator( doc.c_str(), doc.size()));
+	std::size_t events = 0;
+	for (;;)
+	{
+		XMLScannerBase::ElementType et = xs.nextItem();
+		if (et == XMLScannerBase::Exit) break;
+		if (et == XMLScannerBase::ErrorOccurred) throw std::runtime_error( "error in benchmark document");
+		++events;
+	}
+	return events;
+}
+
+typedef XMLPathSelectAutomaton<charset::UTF8> Automaton;
+
+/// \brief Get the automaton of the selector benchmark (selecting something in every corpus)
+static const Automaton* benchAutomaton()
+{
+	static Automaton atm;
+	static bool initialized = false;
+	if (!initialized)
+	{
+		(*atm)["doc"]["rec"]("id") = 1;
+		(*atm)["doc"]["rec"]("a3") = 2;
+		(*atm)["doc"]["p"]() = 3;
+		(*atm)--["n40"]() = 4;
+		(*atm)["doc"]["e"]("v") = 5;
+		initialized = true;
+	}
+	return &atm;
+}
+
+/// \brief Get the automaton of the selector benchmark with many expressions (as in large mapping configurations), compiled or not
+static const Automaton* benchAutomatonMany( bool compiled)
+{
+	static Automaton atm[2];
+	static bool initialized = false;
+	if (!initialized)
+	{
+		for (unsigned int ai=0; ai<2; ++ai)
+		{
+			for (int ii=0; ii<400; ++ii)
+			{
+				std::ostringstream tag, attr;
+				tag << "t" << ii;
+				attr << "x" << ii;
+				(*atm[ai])["doc"][ tag.str().c_str()]() = 10 + 2*ii;
+				(*atm[ai])["doc"]["rec"]( attr.str().c_str()) = 11 + 2*ii;
+			}
+			(*atm[ai])["doc"]["rec"]("id") = 1;
+			(*atm[ai])["doc"]["rec"]("a3") = 2;
+			(*atm[ai])["doc"]["p"]() = 3;
+			(*atm[ai])["doc"]["e"]("v") = 5;
+		}
+		atm[1].compile();
+		initialized = true;
+	}
+	return &atm[ compiled?1:0];
+}
+
+/// \brief Scan a document and push the elements to an XMLPathSelect
+/// \return the number of events of the document
+template <class CharSet>
+static std::size_t runSelector( const std::string& doc, const Automaton* atm)
+{
+	typedef XMLScanner<SrcIterator,CharSet,charset::UTF8,std::string> Scanner;
+	typedef XMLPathSelect<charset::UTF8> Selector;
+	Scanner xs( SrcIterator( doc.c_str(), doc.size()));
+	Selector sel( atm);
+	std::size_t events = 0;
+	for (;;)
+	{
+		XMLScannerBase::ElementType et = xs.nextItem();
+		if (et == XMLScannerBase::Exit) break;
+		if (et == XMLScannerBase::ErrorOccurred) throw std::runtime_error( "error in benchmark document");
+		typename Selector::iterator si = sel.push( et, xs.getItemPtr(), xs.getItemSize()), se = sel.end();
+		for (; si != se; ++si){}
+		++events;
+	}
+	return events;
+}
+
+/// \class CountHandler
+/// \brief Handler of XMLExtractor counting the elements selected
+struct CountHandler
+{
+	std::size_t count;
+
+	CountHandler() :count(0){}
+
+	void selected( int, XMLScannerBase::ElementType, const char*, std::size_t)
+	{
+		++count;
+	}
+};
+
+/// \brief Select the elements of a document with XMLExtractor
+/// \return the number of elements selected (the extractor skips the elements nobody selects, so it does not see all events of the document)
+template <class CharSet>
+static std::size_t runExtractor( const std::string& doc)
+{
+	typedef XMLScanner<SrcIterator,CharSet,charset::UTF8,std::string> Scanner;
+	typedef XMLPathSelect<charset::UTF8> Selector;
+	Scanner xs( SrcIterator( doc.c_str(), doc.size()));
+	Selector sel( benchAutomaton());
+	CountHandler handler;
+	XMLExtractor<Scanner,Selector,CountHandler> extractor( xs, sel, handler);
+	if (extractor.run() != XMLScannerBase::Exit) throw std::runtime_error( "error in benchmark document");
+	return handler.count;
+}
+
+/// \brief Print the elements of a document scanned before with XMLPrinter
+/// \return the number of events of the document
+template <class CharSet>
+static std::size_t runPrinter( const XMLScannerBase::EventBatch& batch, std::string& out)
+{
+	typedef XMLPrinter<CharSet,charset::UTF8,std::string> Printer;
+	Printer printer( true);
+	out.clear();
+	std::size_t ii = 0, nn = batch.size();
+	for (; ii < nn; ++ii)
+	{
+		const char* content = batch.content( ii);
+		std::size_t contentSize = batch.contentSize( ii);
+		bool ok = true;
+		switch (batch.type( ii))
+		{
+			case XMLScannerBase::OpenTag: ok = printer.printOpenTag( content, contentSize, out); break;
+			case XMLScannerBase::TagAttribName: ok = printer.printAttribute( content, contentSize, out); break;
+			case XMLScannerBase::TagAttribValue:
+			case XMLScannerBase::Content: ok = printer.printValue( content, contentSize, out); break;
+			case XMLScannerBase::CloseTag:
+			case XMLScannerBase::CloseTagIm: ok = printer.printCloseTag( out); break;
+			case XMLScannerBase::Exit: return ii;
+			default: break;
+		}
+		if (!ok) throw std::runtime_error( "error printing benchmark document");
+	}
+	return nn;
+}
+
+enum Benchmark {BenchScanner,BenchSelector,BenchSelectorMany,BenchSelectorCompiled,BenchExtractor,BenchPrinter};
+
+template <class CharSet>
+static Measure measure( Benchmark bm, const std::string& doc, unsigned int repeat)
+{
+	Measure rt;
+	rt.bytes = doc.size();
+	rt.events = runScanner<CharSet>( doc);
+	rt.seconds = 0.0;
+	XMLScannerBase::EventBatch batch;
+	std::string out;
+	if (bm == BenchPrinter)
+	{
+		typedef XMLScanner<SrcIterator,CharSet,charset::UTF8,std::string> Scanner;
+		Scanner xs( SrcIterator( doc.c_str(), doc.size()));
+		xs.nextItems( batch, (std::size_t)-1);
+	}
+	for (unsigned int ri=0; ri<repeat; ++ri)
+	{
+		double start = cputime();
+		std::size_t events = rt.events;
+		switch (bm)
+		{
+			case BenchScanner: events = runScanner<CharSet>( doc); break;
+			case BenchSelector: events = runSelector<CharSet>( doc, benchAutomaton()); break;
+			case BenchSelectorMany: events = runSelector<CharSet>( doc, benchAutomatonMany( false)); break;
+			case BenchSelectorCompiled: events = runSelector<CharSet>( doc, benchAutomatonMany( true)); break;
+			case BenchExtractor: if (!runExtractor<CharSet>( doc)) throw std::runtime_error( "nothing selected in benchmark document"); break;
+			case BenchPrinter: events = runPrinter<CharSet>( batch, out); rt.bytes = out.size(); break;
+		}
+		double tm = cputime() - start;
+		if (events != rt.events) throw std::runtime_error( "benchmark did not process all events of the document");
+		if (ri == 0 || tm < rt.seconds) rt.seconds = tm;
+	}
+	return rt;
+}
+
+static void printResult( std::ostream& out, bool first, const char* benchmark, const char* corpus, const char* charset, const Measure& mm)
+{
+	double seconds = (mm.seconds > 0.0) ? mm.seconds : 1e-9;
+	out << (first ? "\n" : ",\n")
+		<< "\t\t{\"benchmark\": \"" << benchmark << "\", \"corpus\": \"" << corpus << "\", \"charset\": \"" << charset << "\""
+		<< ", \"bytes\": " << mm.bytes << ", \"events\": " << mm.events << ", \"seconds\": " << mm.seconds
+		<< ", \"MB_per_s\": " << (mm.bytes / seconds / 1e6) << ", \"events_per_s\": " << (mm.events / seconds) << "}";
+}
+
+template <class CharSet>
+static void runCorpus( std::ostream& out, bool& first, const char* corpus, const char* charsetName, const std::string& utf8doc, unsigned int repeat)
+{
+	std::string doc = encode<CharSet>( utf8doc);
+	static const char* bmName[] = {"scanner","selector","selector_many","selector_compiled","extractor","printer"};
+	for (unsigned int bi=0; bi<6; ++bi)
+	{
+		Measure mm = measure<CharSet>( (Benchmark)bi, doc, repeat);
+		printResult( out, first, bmName[ bi], corpus, charsetName, mm);
+		first = false;
+	}
+}
+
+int main( int argc, const char** argv)
+{
+	std::size_t size = 4096;
+	unsigned int repeat = 5;
+	for (int ai=1; ai<argc; ++ai)
+	{
+		if (std::strcmp( argv[ai], "-s") == 0 && ai+1 < argc)
+		{
+			size = (std::size_t)std::atol( argv[++ai]);
+		}
+		else if (std::strcmp( argv[ai], "-r") == 0 && ai+1 < argc)
+		{
+			repeat = (unsigned int)std::atoi( argv[++ai]);
+		}
+		else
+		{
+			std::cerr << "usage: textwolfbench [-s <corpus size in KB>] [-r <number of repetitions>]" << std::endl;
+			return 1;
+		}
+	}
+	if (size == 0 || repeat == 0)
+	{
+		std::cerr << "illegal arguments" << std::endl;
+		return 1;
+	}
+	try
+	{
+		static const char* corpusName[] = {"attributes","content","nesting","entities"};
+		std::string corpus[4];
+		corpus[0] = corpusAttributes( size * 1024);
+		corpus[1] = corpusContent( size * 1024);
+		corpus[2] = corpusNesting( size * 1024);
+		corpus[3] = corpusEntities( size * 1024);
+
+		std::ostringstream out;
+		out << "{\n\t\"textwolf_version\": \"" << _TEXTWOLF_VERSION_MAJOR << "." << _TEXTWOLF_VERSION_MINOR << "." << _TEXTWOLF_VERSION_REVISION << "\""
+			<< ",\n\t\"corpus_size\": " << (size * 1024)
+			<< ",\n\t\"repeat\": " << repeat
+			<< ",\n\t\"results\": [";
+		bool first = true;
+		for (unsigned int ci=0; ci<4; ++ci)
+		{
+			runCorpus<charset::UTF8>( out, first, corpusName[ci], "UTF-8", corpus[ci], repeat);
+			runCorpus<charset::UTF16LE>( out, first, corpusName[ci], "UTF-16LE", corpus[ci], repeat);
+			runCorpus<charset::UTF16BE>( out, first, corpusName[ci], "UTF-16BE", corpus[ci], repeat);
+			runCorpus<charset::UCS4LE>( out, first, corpusName[ci], "UCS-4LE", corpus[ci], repeat);
+			runCorpus<charset::UCS4BE>( out, first, corpusName[ci], "UCS-4BE", corpus[ci], repeat);
+			runCorpus<charset::IsoLatin>( out, first, corpusName[ci], "IsoLatin-1", corpus[ci], repeat);
+		}
+		out << "\n\t]\n}\n";
+		std::cout << out.str();
+		return 0;
+	}
+	catch (const std::exception& ee)
+	{
+		std::cerr << "ERROR " << ee.what() << std::endl;
+		return 1;
+	}
+}
@@ -5,6 +5,19 @@
 #include <iostream>
 #include <string>
 
+// Handler printing the elements selected:
+struct Output
+{
+	const char* name;
+	const char* content;
+	std::size_t size;
+
+	void operator()( int type)
+	{
+		std::cout << type << ": " << name << std::string( content, size) << std::endl;
+	}
+};
+
 void output( const std::string& str)
 {
 	typedef textwolf::charset::UTF8 Encoding;
@@ -19,7 +32,7 @@ void output( const std::string& str)
 	Scanner scanner( str);
 	Selector selector( &atm);
 
-	// Fetch the input elements, feed them to the selector and iterate on the result dropping out:
+	// Fetch the input elements and feed them to the selector, that calls the handler for every result dropping out:
 	Scanner::iterator itr = scanner.begin(), end = scanner.end();
 	for (; itr != end; itr++)
 	{
@@ -27,13 +40,8 @@ void output( const std::string& str)
 		{
 			throw std::runtime_error( std::string("xml error: ") + itr->error());
 		}
-		std::string elem = std::string( itr->content(), itr->size());
-		Selector::iterator si = selector.push( itr->type(), elem), se = selector.end();
-
-		for (; si!=se; si++)
-		{
-			std::cout << *si << ": " << itr->name() << elem << std::endl;
-		}
+		Output out = {itr->name(), itr->content(), itr->size()};
+		selector.select( itr->type(), itr->content(), itr->size(), out);
 	}
 }
 
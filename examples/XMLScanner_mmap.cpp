@@ -0,0 +1,28 @@
+#include "textwolf/xmlscanner.hpp"
+#include "textwolf/charset.hpp"
+#include "textwolf/mmapiterator.hpp"
+#include <iostream>
+#include <string>
+
+void output( const char* filename)
+{
+	typedef textwolf::charset::UTF8 MyEncoding;
+	typedef textwolf::MMapIterator MyIterator;
+	typedef textwolf::XMLScanner<MyIterator,MyEncoding,MyEncoding,std::string> MyScanner;
+
+	textwolf::MMapFile file( filename);
+	MyIterator mi( file);
+	MyScanner scan( mi);
+	scan.setZeroCopy();
+	MyScanner::iterator itr = scan.begin(), end = scan.end();
+
+	for (; itr != end; ++itr)
+	{
+		if (itr->error())
+		{
+			throw std::runtime_error( std::string("xml error: ") + itr->error());
+		}
+		std::string elem = std::string(itr->content(),itr->size());
+		std::cout << itr->name() << " " << elem << std::endl;
+	}
+}
@@ -14,17 +14,26 @@
 #include "textwolf/char.hpp"
 #include "textwolf/exception.hpp"
 #include "textwolf/staticbuffer.hpp"
+#include "textwolf/arenabuffer.hpp"
 #include "textwolf/ostreamoutput.hpp"
 #include "textwolf/charset_interface.hpp"
 #include "textwolf/charset.hpp"
+#include "textwolf/utf8block.hpp"
 #include "textwolf/textscanner.hpp"
+#include "textwolf/entitymap.hpp"
+#include "textwolf/symboltable.hpp"
+#include "textwolf/binaryimage.hpp"
 #include "textwolf/xmlscanner.hpp"
 #include "textwolf/cstringiterator.hpp"
 #include "textwolf/sourceiterator.hpp"
+#include "textwolf/mmapiterator.hpp"
 #include "textwolf/xmltagstack.hpp"
 #include "textwolf/xmlprinter.hpp"
 #include "textwolf/xmlhdrparser.hpp"
+#include "textwolf/scannerfactory.hpp"
 #include "textwolf/xmlpathselect.hpp"
+#include "textwolf/xmlparallelselect.hpp"
+#include "textwolf/xmlextractor.hpp"
 
 #endif
 
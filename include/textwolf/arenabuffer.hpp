@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \file textwolf/arenabuffer.hpp
+/// \brief Output buffer keeping all elements written to it in a chunked arena until an explicit reset
+
+#ifndef __TEXTWOLF_ARENA_BUFFER_HPP__
+#define __TEXTWOLF_ARENA_BUFFER_HPP__
+#include "textwolf/exception.hpp"
+#include <cstddef>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <new>
+
+namespace textwolf {
+
+/// \class ArenaBuffer
+/// \brief Back insertion sequence for the output of textwolf, that keeps the previous contents when cleared
+/// \remark The content is written contiguously into chunks of memory allocated with a bump allocator. Clearing the buffer starts a new string after the current one, so that the strings returned as StringRef stay valid until reset() is called or the buffer is destroyed. The current string is always null terminated.
+class ArenaBuffer :public throws_exception
+{
+public:
+	/// \class StringRef
+	/// \brief View on a string in the arena (not owning it), valid until ArenaBuffer::reset() is called
+	class StringRef
+	{
+	public:
+		StringRef()
+			:m_ptr(""),m_size(0){}
+		StringRef( const char* ptr_, std::size_t size_)
+			:m_ptr(ptr_),m_size(size_){}
+		StringRef( const StringRef& o)
+			:m_ptr(o.m_ptr),m_size(o.m_size){}
+
+		/// \brief Pointer to the null terminated string
+		const char* ptr() const			{return m_ptr;}
+		/// \brief Size of the string in bytes
+		std::size_t size() const		{return m_size;}
+		/// \brief Copy of the string
+		std::string str() const			{return std::string( m_ptr, m_size);}
+
+		bool operator==( const StringRef& o) const	{return m_size == o.m_size && std::memcmp( m_ptr, o.m_ptr, m_size) == 0;}
+		bool operator!=( const StringRef& o) const	{return !operator==( o);}
+
+	private:
+		const char* m_ptr;		///< pointer to the string
+		std::size_t m_size;		///< size of the string in bytes
+	};
+
+	/// \brief Constructor
+	/// \param [in] chunksize_ size of the chunks of memory allocated in bytes (strings bigger than a chunk get a chunk of their own)
+	explicit ArenaBuffer( std::size_t chunksize_=DefaultChunkSize)
+		:m_chunksize(chunksize_?chunksize_:DefaultChunkSize),m_str(0),m_size(0),m_end(0)
+	{
+		allocChunk( 1);
+	}
+
+	/// \brief Copy constructor (copies only the current string into a new arena)
+	ArenaBuffer( const ArenaBuffer& o)
+		:throws_exception(),m_chunksize(o.m_chunksize),m_str(0),m_size(0),m_end(0)
+	{
+		allocChunk( o.m_size + 1);
+		append( o.m_str, o.m_size);
+	}
+
+	/// \brief Destructor
+	~ArenaBuffer()
+	{
+		std::vector<char*>::const_iterator ci = m_chunks.begin(), ce = m_chunks.end();
+		for (; ci != ce; ++ci) std::free( *ci);
+	}
+
+	/// \brief Start a new string after the current one, the previous strings stay valid
+	/// \remark If the current string is empty, it is reused
+	void clear()
+	{
+		if (m_size)
+		{
+			m_str += m_size + 1;
+			m_size = 0;
+			if (m_str >= m_end) allocChunk( 1);
+			m_str[0] = 0;
+		}
+	}
+
+	/// \brief Free all strings, keeps the first chunk of memory for reuse
+	void reset()
+	{
+		std::vector<char*>::const_iterator ci = m_chunks.begin() + 1, ce = m_chunks.end();
+		for (; ci != ce; ++ci) std::free( *ci);
+		m_chunks.resize( 1);
+		m_str = m_chunks[0];
+		m_end = m_str + m_chunksizes[0];
+		m_chunksizes.resize( 1);
+		m_size = 0;
+		m_str[0] = 0;
+	}
+
+	/// \brief Append one character
+	/// \param[in] ch the character to append
+	void push_back( char ch)
+	{
+		if (m_str + m_size + 1 >= m_end) grow( 1);
+		m_str[ m_size++] = ch;
+		m_str[ m_size] = 0;
+	}
+
+	/// \brief Append an array of characters
+	/// \param[in] cc the characters to append
+	/// \param[in] ccsize the number of characters to append
+	void append( const char* cc, std::size_t ccsize)
+	{
+		if (m_str + m_size + ccsize >= m_end) grow( ccsize);
+		std::memcpy( m_str + m_size, cc, ccsize);
+		m_size += ccsize;
+		m_str[ m_size] = 0;
+	}
+
+	/// \brief Return the number of characters of the current string
+	/// \return the number of characters (bytes)
+	std::size_t size() const		{return m_size;}
+
+	/// \brief Return the current string as 0-terminated string
+	/// \return the C-string
+	const char* ptr() const			{return m_str;}
+
+	/// \brief Return a view on the current string, valid until reset() is called
+	/// \remark An empty string does not occupy space in the arena, the view returned for it is a static empty string
+	StringRef ref() const			{return m_size?StringRef( m_str, m_size):StringRef();}
+
+	/// \brief Shrinks the size of the current string or expands it with c
+	/// \param [in] n new size of the string
+	/// \param [in] c fill character if n bigger than the current size
+	void resize( std::size_t n, char c=0)
+	{
+		if (m_size > n)
+		{
+			m_size = n;
+			m_str[ m_size] = 0;
+		}
+		else
+		{
+			while (n > m_size) push_back( c);
+		}
+	}
+
+	/// \brief random access of element
+	/// \param [in] ii
+	/// \return the character at this position
+	char operator []( std::size_t ii) const
+	{
+		if (ii > m_size) throw exception( DimOutOfRange);
+		return m_str[ii];
+	}
+
+	/// \brief random access of element reference
+	/// \param [in] ii
+	/// \return the reference to the character at this position
+	char& at( std::size_t ii) const
+	{
+		if (ii > m_size) throw exception( DimOutOfRange);
+		return m_str[ii];
+	}
+
+	/// \brief Get the number of bytes of memory allocated
+	std::size_t allocated() const
+	{
+		std::size_t rt = 0;
+		std::vector<std::size_t>::const_iterator ci = m_chunksizes.begin(), ce = m_chunksizes.end();
+		for (; ci != ce; ++ci) rt += *ci;
+		return rt;
+	}
+
+private:
+	enum {DefaultChunkSize=16384};
+
+	ArenaBuffer& operator=( const ArenaBuffer&);	//... non assignable
+
+	/// \brief Allocate a new chunk with space for at least n bytes and start the current string at its beginning
+	void allocChunk( std::size_t n)
+	{
+		std::size_t chunksize = (n > m_chunksize / 2) ? (n * 2) : m_chunksize;
+		char* chunk = (char*)std::malloc( chunksize);
+		if (!chunk) throw exception( OutOfMem);
+		try
+		{
+			m_chunks.push_back( chunk);
+			m_chunksizes.push_back( chunksize);
+		}
+		catch (const std::bad_alloc&)
+		{
+			if (m_chunks.size() > m_chunksizes.size()) m_chunks.pop_back();
+			std::free( chunk);
+			throw exception( OutOfMem);
+		}
+		m_str = chunk;
+		m_size = 0;
+		m_end = chunk + chunksize;
+		m_str[0] = 0;
+	}
+
+	/// \brief Move the current string to a new chunk with space for n bytes more
+	void grow( std::size_t n)
+	{
+		const char* str = m_str;
+		std::size_t size = m_size;
+		allocChunk( size + n + 1);
+		std::memcpy( m_str, str, size);
+		m_size = size;
+		m_str[ m_size] = 0;
+	}
+
+private:
+	std::size_t m_chunksize;		///< default size of a chunk allocated
+	std::vector<char*> m_chunks;		///< chunks of memory allocated
+	std::vector<std::size_t> m_chunksizes;	///< sizes of the chunks allocated
+	char* m_str;				///< start of the current string
+	std::size_t m_size;			///< size of the current string
+	char* m_end;				///< end of the current chunk
+};
+
+}//namespace
+#endif
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \file textwolf/binaryimage.hpp
+/// \brief Writer and reader of position independent binary images of data structures
+
+#ifndef __TEXTWOLF_BINARY_IMAGE_HPP__
+#define __TEXTWOLF_BINARY_IMAGE_HPP__
+#include "textwolf/exception.hpp"
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace textwolf {
+
+/// \class BinaryImageWriter
+/// \brief Writer of a binary image as sequence of words (unsigned int in native byte order) and byte strings
+/// \remark Every word is aligned to its size relative to the start of the image. The image contains no pointers, only sizes and indices, so it is position independent.
+class BinaryImageWriter
+{
+public:
+	/// \brief Constructor
+	/// \param [in,out] image_ where to append the image to
+	explicit BinaryImageWriter( std::string& image_)
+		:m_image(&image_){}
+
+	/// \brief Append a word
+	/// \param [in] value value to append
+	void word( unsigned int value)
+	{
+		align();
+		m_image->append( (const char*)&value, sizeof(value));
+	}
+
+	/// \brief Append a byte string with its size
+	/// \param [in] ptr pointer to the bytes
+	/// \param [in] size number of bytes
+	void bytes( const char* ptr, std::size_t size)
+	{
+		word( (unsigned int)size);
+		m_image->append( ptr, size);
+	}
+
+	/// \brief Append a sequence of integers as words with its size
+	/// \tparam Vector random access container of integer values
+	/// \param [in] vv the sequence
+	template <class Vector>
+	void words( const Vector& vv)
+	{
+		word( (unsigned int)vv.size());
+		for (std::size_t ii=0; ii<vv.size(); ++ii) word( (unsigned int)vv[ ii]);
+	}
+
+private:
+	void align()
+	{
+		while (m_image->size() % sizeof(unsigned int) != 0) m_image->push_back( '\0');
+	}
+
+private:
+	std::string* m_image;		///< image written
+};
+
+/// \class BinaryImageReader
+/// \brief Reader of a binary image written with a BinaryImageWriter
+/// \remark Throws an exception with cause InvalidImage if it is read beyond the end of the image. The reader does not copy the image, the byte strings returned point into it and have to be copied by the caller if they are needed after the image is released.
+class BinaryImageReader :public throws_exception
+{
+public:
+	/// \brief Constructor
+	/// \param [in] image_ start of the image
+	/// \param [in] size_ size of the image in bytes
+	BinaryImageReader( const void* image_, std::size_t size_)
+		:m_ptr((const char*)image_),m_size(size_),m_pos(0){}
+
+	/// \brief Read the next word
+	/// \return the value read
+	unsigned int word()
+	{
+		align();
+		need( sizeof(unsigned int));
+		unsigned int rt;
+		std::memcpy( &rt, m_ptr + m_pos, sizeof(rt));
+		m_pos += sizeof(rt);
+		return rt;
+	}
+
+	/// \brief Read the next byte string
+	/// \param [out] size number of bytes
+	/// \return pointer to the bytes in the image
+	const char* bytes( std::size_t& size)
+	{
+		size = word();
+		need( size);
+		const char* rt = m_ptr + m_pos;
+		m_pos += size;
+		return rt;
+	}
+
+	/// \brief Read the next sequence of words
+	/// \tparam Vector container of integer values with resize(std::size_t)
+	/// \param [out] vv the sequence read
+	template <class Vector>
+	void words( Vector& vv)
+	{
+		std::size_t nn = word();
+		if (nn > (m_size - m_pos) / sizeof(unsigned int)) throw exception( InvalidImage);
+		vv.resize( nn);
+		for (std::size_t ii=0; ii<nn; ++ii) vv[ ii] = (typename Vector::value_type)word();
+	}
+
+	/// \brief Find out if the whole image has been read
+	/// \return true, if yes
+	bool eof() const
+	{
+		return m_pos == m_size;
+	}
+
+private:
+	void align()
+	{
+		std::size_t rest = m_pos % sizeof(unsigned int);
+		if (rest)
+		{
+			need( sizeof(unsigned int) - rest);
+			m_pos += sizeof(unsigned int) - rest;
+		}
+	}
+
+	void need( std::size_t nn) const
+	{
+		if (nn > m_size - m_pos) throw exception( InvalidImage);
+	}
+
+private:
+	const char* m_ptr;		///< start of the image
+	std::size_t m_size;		///< size of the image in bytes
+	std::size_t m_pos;		///< read position
+};
+
+}//namespace
+#endif
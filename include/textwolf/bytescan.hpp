@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \file textwolf/bytescan.hpp
+/// \brief Bulk search for the first occurrence of a byte out of a set in a contiguous memory block
+/// \remark Uses SSE2 or AVX2 if available at compile time (define TEXTWOLF_NO_SIMD to disable), a scalar loop otherwise
+
+#ifndef __TEXTWOLF_BYTE_SCAN_HPP__
+#define __TEXTWOLF_BYTE_SCAN_HPP__
+#include <cstddef>
+#include <cstring>
+
+#if !defined(TEXTWOLF_NO_SIMD)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TEXTWOLF_SIMD_AVX2
+#define TEXTWOLF_SIMD_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTWOLF_SIMD_SSE2
+#endif
+#endif
+#if defined(_MSC_VER) && defined(TEXTWOLF_SIMD_SSE2)
+#include <intrin.h>
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define TEXTWOLF_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define TEXTWOLF_NO_SANITIZE_ADDRESS
+#endif
+
+namespace textwolf {
+
+/// \class ByteSet
+/// \brief Set of bytes with a bulk search for the first byte of a memory block belonging to it
+/// \remark The search is vectorized for sets of up to MaxNofVectorBytes single bytes plus optionally all bytes with the high bit set. Bigger sets are searched with a table driven scalar loop.
+class ByteSet
+{
+public:
+	enum
+	{
+		MaxNofVectorBytes=8		///< maximum number of single bytes in the set for a vectorized search
+	};
+
+	/// \brief Constructor (empty set)
+	ByteSet()
+		:m_size(0),m_highbit(false)
+	{
+		std::memset( m_map, 0, sizeof(m_map));
+	}
+
+	/// \brief Copy constructor
+	/// \param [in] o byte set to copy
+	ByteSet( const ByteSet& o)
+		:m_size(o.m_size),m_highbit(o.m_highbit)
+	{
+		std::memcpy( m_map, o.m_map, sizeof(m_map));
+		std::memcpy( m_ar, o.m_ar, sizeof(m_ar));
+	}
+
+	/// \brief Add a byte to the set
+	/// \param [in] ch the byte to add
+	/// \return *this
+	ByteSet& operator()( unsigned char ch)
+	{
+		if (m_map[ ch]) return *this;
+		m_map[ ch] = true;
+		if (ch >= 0x80 && m_highbit) return *this;
+		if (m_size < (unsigned int)MaxNofVectorBytes) m_ar[ m_size] = (char)ch;
+		++m_size;
+		return *this;
+	}
+
+	/// \brief Add all bytes with the high bit set [0x80..0xFF] to the set
+	/// \return *this
+	ByteSet& highbit()
+	{
+		unsigned int ii;
+		for (ii=0x80; ii<=0xFF; ++ii) m_map[ ii] = true;
+		m_highbit = true;
+		unsigned int kk = 0;
+		for (ii=0; ii<m_size && ii<(unsigned int)MaxNofVectorBytes; ++ii)
+		{
+			if ((unsigned char)m_ar[ ii] < 0x80) m_ar[ kk++] = m_ar[ ii];
+		}
+		if (m_size <= (unsigned int)MaxNofVectorBytes) m_size = kk;
+		return *this;
+	}
+
+	/// \brief Test if a byte belongs to the set
+	/// \param [in] ch byte to test
+	/// \return true if yes
+	bool contains( unsigned char ch) const
+	{
+		return m_map[ ch];
+	}
+
+	/// \brief Find the first byte belonging to the set
+	/// \param [in] pp start of the block to search in
+	/// \param [in] ee end of the block to search in or NULL if the block is null terminated (then '\0' has to belong to the set)
+	/// \return pointer to the first byte found or 'ee' if no byte of the set is found
+	const char* find( const char* pp, const char* ee) const
+	{
+		if (!ee) return findz( pp);
+#if defined(TEXTWOLF_SIMD_SSE2)
+		if (m_size <= (unsigned int)MaxNofVectorBytes)
+		{
+#if defined(TEXTWOLF_SIMD_AVX2)
+			for (; ee - pp >= 32; pp += 32)
+			{
+				unsigned int mm = match32( _mm256_loadu_si256( (const __m256i*)pp));
+				if (mm) return pp + ctz( mm);
+			}
+#endif
+			for (; ee - pp >= 16; pp += 16)
+			{
+				unsigned int mm = match16( _mm_loadu_si128( (const __m128i*)pp));
+				if (mm) return pp + ctz( mm);
+			}
+		}
+#endif
+		for (; pp != ee && !m_map[ (unsigned char)*pp]; ++pp){}
+		return pp;
+	}
+
+private:
+	/// \brief Find the first byte belonging to the set in a null terminated block
+	/// \remark Reads only aligned blocks in the vectorized search, so it never touches a memory page not containing a byte of the block (but it may read bytes beyond the null terminator, therefore not checked by the address sanitizer)
+	TEXTWOLF_NO_SANITIZE_ADDRESS const char* findz( const char* pp) const
+	{
+#if defined(TEXTWOLF_SIMD_SSE2)
+		if (m_size <= (unsigned int)MaxNofVectorBytes && m_map[0])
+		{
+			std::size_t ofs = (std::size_t)pp & 15;
+			const char* aa = pp - ofs;
+			unsigned int mm = match16( _mm_load_si128( (const __m128i*)aa)) >> ofs;
+			if (mm) return pp + ctz( mm);
+			for (aa += 16;; aa += 16)
+			{
+				mm = match16( _mm_load_si128( (const __m128i*)aa));
+				if (mm) return aa + ctz( mm);
+			}
+		}
+#endif
+		for (; !m_map[ (unsigned char)*pp]; ++pp){}
+		return pp;
+	}
+
+#if defined(TEXTWOLF_SIMD_SSE2)
+	/// \brief Get the bit mask of the bytes of a 16 byte block belonging to the set
+	unsigned int match16( __m128i vv) const
+	{
+		__m128i acc = m_highbit ? vv : _mm_setzero_si128();
+		for (unsigned int ii=0; ii<m_size; ++ii)
+		{
+			acc = _mm_or_si128( acc, _mm_cmpeq_epi8( vv, _mm_set1_epi8( m_ar[ ii])));
+		}
+		return (unsigned int)_mm_movemask_epi8( acc);
+	}
+#endif
+#if defined(TEXTWOLF_SIMD_AVX2)
+	/// \brief Get the bit mask of the bytes of a 32 byte block belonging to the set
+	unsigned int match32( __m256i vv) const
+	{
+		__m256i acc = m_highbit ? vv : _mm256_setzero_si256();
+		for (unsigned int ii=0; ii<m_size; ++ii)
+		{
+			acc = _mm256_or_si256( acc, _mm256_cmpeq_epi8( vv, _mm256_set1_epi8( m_ar[ ii])));
+		}
+		return (unsigned int)_mm256_movemask_epi8( acc);
+	}
+#endif
+	/// \brief Count trailing zero bits of a non zero value
+	static inline unsigned int ctz( unsigned int mm)
+	{
+#if defined(_MSC_VER) && defined(TEXTWOLF_SIMD_SSE2)
+		unsigned long rt;
+		_BitScanForward( &rt, mm);
+		return (unsigned int)rt;
+#elif defined(__GNUC__)
+		return (unsigned int)__builtin_ctz( mm);
+#else
+		unsigned int rt = 0;
+		for (; (mm & 1) == 0; mm >>= 1,++rt){}
+		return rt;
+#endif
+	}
+
+private:
+	bool m_map[ 256];				///< set membership by byte value
+	char m_ar[ MaxNofVectorBytes];			///< single bytes of the set compared in the vectorized search (without high bit bytes if m_highbit is set)
+	unsigned int m_size;				///< number of single bytes in the set (without high bit bytes if m_highbit is set)
+	bool m_highbit;					///< true, if all bytes with the high bit set belong to the set
+};
+
+}//namespace
+#endif
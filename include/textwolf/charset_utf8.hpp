@@ -13,6 +13,7 @@
 #include "textwolf/char.hpp"
 #include "textwolf/charset_interface.hpp"
 #include "textwolf/exception.hpp"
+#include "textwolf/utf8block.hpp"
 #include <cstddef>
 
 namespace textwolf {
@@ -23,7 +24,9 @@ namespace charset {
 struct UTF8
 {
 	/// \brief Maximum character that can be represented by this encoding implementation
-	enum {MaxChar=0x7FFFFFFFU};
+	enum {MaxChar=0x10FFFFU};
+	/// \brief Character returned for malformed input (outside the alphabet)
+	enum {InvalidChar=0x7FFFFFFFU};
 	/// \brief Size of basic data type unit used for encoding
 	enum {UnitSize=1};
 
@@ -54,19 +57,18 @@ struct UTF8
 
 	/// \class CharLengthTab
 	/// \brief Table that maps the first UTF-8 character byte to the length of the character in bytes
+	/// \remark Bytes that cannot start a character in UTF-8 as defined in RFC 3629 (continuation bytes, the overlong lead bytes 0xC0,0xC1 and [0xF5..0xFF], 5 to 8 byte forms of the original definition) are single invalid characters
 	struct CharLengthTab	:public CharMap<unsigned char, 0>
 	{
 		CharLengthTab()
 		{
 			(*this)
 			(B00000000,B01111111,1)
-			(B11000000,B11011111,2)
+			(B10000000,0xC1,1)
+			(0xC2,B11011111,2)
 			(B11100000,B11101111,3)
-			(B11110000,B11110111,4)
-			(B11111000,B11111011,5)
-			(B11111100,B11111101,6)
-			(B11111110,B11111110,7)
-			(B11111111,B11111111,8);
+			(B11110000,0xF4,4)
+			(0xF5,B11111111,1);
 		}
 	};
 
@@ -77,25 +79,50 @@ struct UTF8
 	template <class Iterator>
 	static inline unsigned int size( char* buf, unsigned int& bufpos, Iterator& itr)
 	{
-		static CharLengthTab charLengthTab;
 		if (bufpos==0)
 		{
 			buf[0] = *itr;
 			++itr;
 			++bufpos;
 		}
-		return charLengthTab[ (unsigned char)buf[ 0]];
+		return charLength( (unsigned char)buf[ 0]);
+	}
+
+	/// \brief Get the size of a character in bytes by its first byte
+	/// \param [in] lead first byte of the character
+	static inline unsigned int charLength( unsigned char lead)
+	{
+		static CharLengthTab charLengthTab;
+		return charLengthTab[ lead];
+	}
+
+	/// \brief Check if a byte continues a multibyte character in strict UTF-8 (RFC 3629)
+	/// \param [in] lead first byte of the character
+	/// \param [in] pos position of the byte in the character (> 0)
+	/// \param [in] ch the byte
+	/// \return true, if the byte is part of the character, false if it has to be parsed as start of the next character
+	static inline bool isContinuation( unsigned char lead, unsigned int pos, unsigned char ch)
+	{
+		if (pos == 1)
+		{
+			switch (lead)
+			{
+				case 0xE0: return ch >= 0xA0 && ch <= 0xBF;
+				case 0xED: return ch >= 0x80 && ch <= 0x9F;
+				case 0xF0: return ch >= 0x90 && ch <= 0xBF;
+				case 0xF4: return ch >= 0x80 && ch <= 0x8F;
+				default: break;
+			}
+		}
+		return (ch & B11000000) == B10000000;
 	}
 
 	/// \brief See template<class Iterator>Interface::skip(char*,unsigned int&,Iterator&)
+	/// \remark The bytes skipped are read, so that a source fed chunk by chunk can interrupt the skip at the end of a chunk and continue it with the next one
 	template <class Iterator>
 	static inline void skip( char* buf, unsigned int& bufpos, Iterator& itr)
 	{
-		unsigned int bufsize = size( buf, bufpos, itr);
-		for (;bufpos < bufsize; ++bufpos)
-		{
-			++itr;
-		}
+		fetchbytes( buf, bufpos, itr);
 	}
 
 	/// \brief See template<class Iterator>Interface::asciichar(char*,unsigned int&,Iterator&)
@@ -121,38 +148,28 @@ struct UTF8
 			++itr;
 			++bufpos;
 		}
+		// ... only the longest valid prefix of a malformed character is consumed, the byte not continuing it
+		//	is never read past, so that a truncated character does not swallow the markup following it
 		unsigned int bufsize = size( buf, bufpos, itr);
-		for (;bufpos < bufsize; ++bufpos)
+		while (bufpos < bufsize)
 		{
-			buf[ bufpos] = *itr;
+			unsigned char ch = (unsigned char)*itr;
+			if (!isContinuation( (unsigned char)buf[0], bufpos, ch)) break;
+			buf[ bufpos++] = (char)ch;
 			++itr;
 		}
 	}
 
 	/// \brief See template<class Iterator>Interface::value(char*,unsigned int&,Iterator&)
+	/// \remark Strict decoding as defined in RFC 3629: returns InvalidChar for malformed characters, overlong encodings, encoded surrogates and characters above 0x10FFFF
 	template <class Iterator>
 	UChar value( char* buf, unsigned int& bufpos, Iterator& itr) const
 	{
 		fetchbytes( buf, bufpos, itr);
-
-		UChar res = (unsigned char)buf[0];
-		if (res > 127)
-		{
-			int gg = bufpos-2;
-			if (gg < 0) return MaxChar;
-
-			res = ((unsigned char)buf[0])&(B00011111>>gg);
-			for (int ii=0; ii<=gg; ii++)
-			{
-				unsigned char xx = (unsigned char)buf[ii+1];
-				res = (res<<6) | (xx & B00111111);
-				if ((unsigned char)(xx & B11000000) != B10000000)
-				{
-					return MaxChar;
-				}
-			}
-		}
-		return res;
+		if ((unsigned char)buf[0] < 0x80) return (unsigned char)buf[0];
+		unsigned int len = UTF8Block::sequenceLength( buf, bufpos);
+		if (len != bufpos) return InvalidChar;
+		return UTF8Block::decode( buf, len);
 	}
 
 	/// \brief See template<class Buffer>Interface::print(UChar,Buffer&)
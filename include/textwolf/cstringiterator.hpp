@@ -78,6 +78,16 @@ public:
 	/// \brief Set current char position
 	inline void pos( unsigned int i)	{m_pos=(i<m_size)?i:m_size;}
 
+	/// \brief Get the pointer to the current character in the contiguous source (for bulk scanning)
+	inline const char* windowBegin() const	{return m_src+m_pos;}
+
+	/// \brief Get the pointer to the end of the contiguous source (for bulk scanning)
+	inline const char* windowEnd() const	{return m_src+m_size;}
+
+	/// \brief Skip a number of characters at once (for bulk scanning)
+	/// \param [in] n number of characters to skip, must not exceed the end of the window
+	inline void windowAdvance( std::size_t n)	{m_pos+=(unsigned int)n;}
+
 	inline int operator - (const CStringIterator& o) const
 	{
 		if (m_src != o.m_src) return 0;
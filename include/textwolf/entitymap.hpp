@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \file textwolf/entitymap.hpp
+/// \brief Dictionary of named XML entities defined by the user
+
+#ifndef __TEXTWOLF_ENTITY_MAP_HPP__
+#define __TEXTWOLF_ENTITY_MAP_HPP__
+#include "textwolf/char.hpp"
+#include "textwolf/exception.hpp"
+#include <vector>
+#include <string>
+#include <cstddef>
+
+/// \namespace textwolf
+/// \brief Toplevel namespace of the library
+namespace textwolf {
+
+/// \class EntityMap
+/// \brief Dictionary of named entities mapped to sequences of unicode characters, implemented as byte trie
+/// \remark The lookup is done in O(length of the name) without allocating memory. The first character is resolved with a table, the following by scanning the (short) sorted list of successors of a node. The characters of all entities are stored in one pool, so that entities standing for more than one character (as some of HTML5, e.g. "NotEqualTilde" for U+2242 U+0338) can be defined. An entity map is read only after its definition and can be shared by any number of scanners, also in different threads.
+class EntityMap
+	:public throws_exception
+{
+public:
+	/// \brief Default constructor (empty map)
+	EntityMap()
+	{
+		init();
+	}
+
+	/// \brief Constructor from an STL map or another container of pairs with the entity name as first (const char* or std::string) and the character (UChar) or the characters (std::vector<UChar>) as second element
+	/// \param [in] map the container with the entity definitions
+	template <class Map>
+	explicit EntityMap( const Map& map)
+	{
+		init();
+		typename Map::const_iterator mi = map.begin(), me = map.end();
+		for (; mi != me; ++mi)
+		{
+			insert( cstr( mi->first), mi->second);
+		}
+	}
+
+	/// \brief Define an entity
+	/// \param [in] name name of the entity (without '&' and ';')
+	/// \param [in] chr unicode character the entity stands for
+	/// \return *this
+	EntityMap& operator()( const char* name, UChar chr)
+	{
+		insert( name, chr);
+		return *this;
+	}
+
+	/// \brief Define an entity standing for a sequence of characters
+	/// \param [in] name name of the entity (without '&' and ';')
+	/// \param [in] chrs unicode characters the entity stands for
+	/// \param [in] nofChrs number of characters (at least one)
+	/// \return *this
+	EntityMap& operator()( const char* name, const UChar* chrs, std::size_t nofChrs)
+	{
+		insert( name, chrs, nofChrs);
+		return *this;
+	}
+
+	/// \brief Get the character defined for an entity for assignment, defines the entity if it does not exist yet (as std::map::operator[])
+	/// \remark An entity defined with more than one character is redefined as entity with one character
+	/// \param [in] name name of the entity (without '&' and ';')
+	/// \return reference to the character, valid until the next entity is defined
+	UChar& operator[]( const char* name)
+	{
+		std::size_t ni = getNode( name);
+		if (!m_nodes[ ni].defined || m_nodes[ ni].valuesize != 1)
+		{
+			defineValue( ni, 0, 1);
+		}
+		return m_values[ m_nodes[ ni].valueofs];
+	}
+
+	/// \brief Define an entity
+	/// \param [in] name name of the entity (without '&' and ';')
+	/// \param [in] chr unicode character the entity stands for
+	void insert( const char* name, UChar chr)
+	{
+		(*this)[ name] = chr;
+	}
+
+	/// \brief Define an entity standing for a sequence of characters
+	/// \param [in] name name of the entity (without '&' and ';')
+	/// \param [in] chrs unicode characters the entity stands for
+	/// \param [in] nofChrs number of characters (at least one)
+	void insert( const char* name, const UChar* chrs, std::size_t nofChrs)
+	{
+		if (nofChrs == 0) throw exception( IllegalParam);
+		defineValue( getNode( name), chrs, nofChrs);
+	}
+
+	/// \brief Define an entity standing for a sequence of characters
+	/// \param [in] name name of the entity (without '&' and ';')
+	/// \param [in] chrs unicode characters the entity stands for (at least one)
+	void insert( const char* name, const std::vector<UChar>& chrs)
+	{
+		insert( name, chrs.empty() ? 0 : &chrs[0], chrs.size());
+	}
+
+	/// \brief Find an entity
+	/// \param [in] name name of the entity (without '&' and ';') as null terminated string
+	/// \param [out] chrs unicode characters the entity stands for
+	/// \param [out] nofChrs number of characters
+	/// \return true, if the entity is defined
+	bool find( const char* name, const UChar*& chrs, std::size_t& nofChrs) const
+	{
+		std::size_t ni = findNode( name);
+		if (!ni) return false;
+		chrs = &m_values[ m_nodes[ ni].valueofs];
+		nofChrs = m_nodes[ ni].valuesize;
+		return true;
+	}
+
+	/// \brief Find an entity
+	/// \param [in] name name of the entity (without '&' and ';') as null terminated string
+	/// \param [out] chr the (first) unicode character the entity stands for
+	/// \return true, if the entity is defined
+	bool find( const char* name, UChar& chr) const
+	{
+		std::size_t ni = findNode( name);
+		if (!ni) return false;
+		chr = m_values[ m_nodes[ ni].valueofs];
+		return true;
+	}
+
+	/// \brief Get the number of entities defined
+	std::size_t size() const
+	{
+		return m_size;
+	}
+
+	/// \brief Check if no entity is defined
+	bool empty() const
+	{
+		return m_size == 0;
+	}
+
+private:
+	/// \class Node
+	/// \brief Node of the trie, the successors of a node are a list sorted by character
+	struct Node
+	{
+		unsigned char chr;		///< character of the name leading to this node
+		bool defined;			///< true, if the name leading to this node is an entity defined
+		std::size_t valueofs;		///< start of the unicode characters of the entity in the pool if defined
+		std::size_t valuesize;		///< number of unicode characters of the entity if defined
+		std::size_t child;		///< first successor node or 0
+		std::size_t next;		///< next node in the list of successors of the predecessor or 0
+
+		Node( unsigned char chr_=0)
+			:chr(chr_),defined(false),valueofs(0),valuesize(0),child(0),next(0){}
+	};
+
+	static const char* cstr( const char* name)		{return name;}
+	static const char* cstr( const std::string& name)	{return name.c_str();}
+
+	void init()
+	{
+		m_size = 0;
+		m_nodes.push_back( Node());	//... node 0 is the null reference
+		for (unsigned int ii=0; ii<256; ++ii) m_first[ ii] = 0;
+	}
+
+	/// \brief Define the characters of the entity of a node, appended to the pool (the characters of a redefined entity stay unused in the pool)
+	/// \param [in] ni index of the node
+	/// \param [in] chrs unicode characters or NULL for characters with value 0
+	/// \param [in] nofChrs number of characters
+	void defineValue( std::size_t ni, const UChar* chrs, std::size_t nofChrs)
+	{
+		Node& node = m_nodes[ ni];
+		if (!node.defined)
+		{
+			node.defined = true;
+			++m_size;
+		}
+		node.valueofs = m_values.size();
+		node.valuesize = nofChrs;
+		if (chrs)
+		{
+			m_values.insert( m_values.end(), chrs, chrs + nofChrs);
+		}
+		else
+		{
+			m_values.resize( m_values.size() + nofChrs, 0);
+		}
+	}
+
+	/// \brief Find the node of a defined entity
+	/// \param [in] name name of the entity as null terminated string
+	/// \return the index of the node or 0, if the entity is not defined
+	std::size_t findNode( const char* name) const
+	{
+		const unsigned char* cc = (const unsigned char*)name;
+		if (!*cc) return 0;
+		std::size_t ni = m_first[ *cc];
+		for (++cc; ni && *cc; ++cc)
+		{
+			ni = m_nodes[ ni].child;
+			while (ni && m_nodes[ ni].chr < *cc) ni = m_nodes[ ni].next;
+			if (ni && m_nodes[ ni].chr != *cc) ni = 0;
+		}
+		return (ni && m_nodes[ ni].defined) ? ni : 0;
+	}
+
+	/// \brief Get the node for a name, create it if it does not exist yet
+	std::size_t getNode( const char* name)
+	{
+		const unsigned char* cc = (const unsigned char*)name;
+		if (!*cc) throw exception( IllegalParam);
+		std::size_t ni = m_first[ *cc];
+		if (!ni)
+		{
+			ni = m_first[ *cc] = m_nodes.size();
+			m_nodes.push_back( Node( *cc));
+		}
+		for (++cc; *cc; ++cc)
+		{
+			// ... find the successor with the character *cc or the place where to insert it into the sorted list
+			std::size_t prev = 0;
+			std::size_t si = m_nodes[ ni].child;
+			while (si && m_nodes[ si].chr < *cc)
+			{
+				prev = si;
+				si = m_nodes[ si].next;
+			}
+			if (!si || m_nodes[ si].chr != *cc)
+			{
+				std::size_t nn = m_nodes.size();
+				m_nodes.push_back( Node( *cc));
+				m_nodes[ nn].next = si;
+				if (prev)
+				{
+					m_nodes[ prev].next = nn;
+				}
+				else
+				{
+					m_nodes[ ni].child = nn;
+				}
+				si = nn;
+			}
+			ni = si;
+		}
+		return ni;
+	}
+
+private:
+	std::size_t m_first[ 256];		///< nodes of the first characters of the names or 0
+	std::vector<Node> m_nodes;		///< nodes of the trie
+	std::vector<UChar> m_values;		///< pool of the unicode characters of all entities
+	std::size_t m_size;			///< number of entities defined
+};
+
+}//namespace
+#endif
@@ -39,7 +39,9 @@ struct throws_exception
 		IllegalXmlHeader,		///< illegal XML header (more than 4 null bytes in a row). Usage error
 		InvalidTagOffset,		///< internal error in the tag stack. Internal textwolf error
 		CorruptTagStack,		///< currupted tag stack. Internal textwolf error
-		CodePageIndexNotSupported	///< the index of the code page specified for a character set encoding is unknown to textwolf. Usage error
+		CodePageIndexNotSupported,	///< the index of the code page specified for a character set encoding is unknown to textwolf. Usage error
+		EncodingNotSupported,		///< the character set encoding specified in the XML header is unknown to textwolf. Usage error
+		InvalidImage			///< a binary image loaded is corrupt or has been written by another version of textwolf or on another platform. Usage error
 	};
 };
 
@@ -71,12 +73,12 @@ struct exception	:public std::runtime_error
 	virtual const char* what() const throw()
 	{
 		// enumeration of exception causes as strings
-		static const char* nameCause[ 17] = {
+		static const char* nameCause[ 19] = {
 			"Unknown","DimOutOfRange","StateNumbersNotAscending","InvalidParamState",
 			"InvalidParamChar","DuplicateStateTransition","InvalidState","IllegalParam",
-			"IllegalAttributeName","OutOfMem","ArrayBoundsReadWrite","NotAllowedOperation"
+			"IllegalAttributeName","OutOfMem","ArrayBoundsReadWrite","NotAllowedOperation",
 			"FileReadError","IllegalXmlHeader","InvalidTagOffset","CorruptTagStack",
-			"CodePageIndexNotSupported"
+			"CodePageIndexNotSupported","EncodingNotSupported","InvalidImage"
 		};
 		return nameCause[ (unsigned int) cause];
 	}
@@ -92,84 +92,158 @@ private:
 
 /// \class IStreamIterator
 /// \brief Input iterator on an STL input stream
+/// \remark The iterator exposes its current buffer (window) for bulk scanning and refills it only at the window boundary. Copies of the iterator share the window, as for any input iterator only one of the copies can be advanced.
 class IStreamIterator
 	:public throws_exception
 {
+private:
+	/// \class Window
+	/// \brief Buffer with the current chunk read from the input stream shared by all copies of an iterator
+	struct Window
+	{
+		IStream* input;			///< input stream
+		char* buf;			///< buffer with the current chunk (with a null byte after the last byte read)
+		std::size_t bufsize;		///< allocation size of the buffer without the terminating null byte
+		std::size_t readsize;		///< number of bytes read into the buffer
+		PositionIndex abspos;		///< absolute position of the start of the buffer in the input
+		unsigned int refcnt;		///< number of iterators sharing the window
+	};
+
 public:
 	/// \brief Default constructor
-	IStreamIterator(){}
+	/// \remark The iterator has no input and is at its end, like an iterator on an empty stream
+	IStreamIterator()
+		:m_win(0),m_itr(emptyWindow()),m_end(emptyWindow()){}
+
 	/// \brief Destructor
 	~IStreamIterator()
 	{
-		std::free(m_buf);
+		release();
 	}
 
 	/// \brief Constructor
 	/// \param [in] input input to iterate on
+	/// \param [in] bufsize size of the window buffer
 	IStreamIterator( IStream* input, std::size_t bufsize=8192)
-		:m_input(input),m_buf((char*)std::malloc(bufsize)),m_bufsize(bufsize),m_readsize(0),m_readpos(0),m_abspos(0)
+		:m_win(0),m_itr(0),m_end(0)
 	{
-		if (!m_buf) throw std::bad_alloc();
+		m_win = (Window*)std::malloc( sizeof(Window));
+		if (!m_win) throw std::bad_alloc();
+		m_win->buf = (char*)std::malloc( bufsize+1);
+		if (!m_win->buf)
+		{
+			std::free( m_win);
+			throw std::bad_alloc();
+		}
+		m_win->input = input;
+		m_win->bufsize = bufsize;
+		m_win->readsize = 0;
+		m_win->abspos = 0;
+		m_win->refcnt = 1;
+		m_itr = m_end = m_win->buf;
 		fillbuf();
 	}
 
 	/// \brief Copy constructor
 	/// \param [in] o iterator to copy
 	IStreamIterator( const IStreamIterator& o)
-		:m_input(o.m_input),m_buf((char*)std::malloc(o.m_bufsize)),m_bufsize(o.m_bufsize),m_readsize(o.m_readsize),m_readpos(o.m_readpos),m_abspos(o.m_abspos)
+		:m_win(o.m_win),m_itr(o.m_itr),m_end(o.m_end)
 	{
-		if (!m_buf) throw std::bad_alloc();
-		std::memcpy( m_buf, o.m_buf, o.m_readsize);
+		if (m_win) ++m_win->refcnt;
+	}
+
+	/// \brief Assignment
+	/// \param [in] o iterator to copy
+	IStreamIterator& operator=( const IStreamIterator& o)
+	{
+		if (o.m_win) ++o.m_win->refcnt;
+		release();
+		m_win = o.m_win;
+		m_itr = o.m_itr;
+		m_end = o.m_end;
+		return *this;
 	}
 
 	/// \brief Element access
 	/// \return current character
 	inline char operator* ()
 	{
-		return (m_readpos < m_readsize)?m_buf[m_readpos]:0;
+		return *m_itr;
 	}
 
 	/// \brief Pre increment
 	inline IStreamIterator& operator++()
 	{
-		if (m_readpos+1 >= m_readsize)
-		{
-			fillbuf();
-		}
-		else
-		{
-			++m_readpos;
-		}
+		if (++m_itr >= m_end) fillbuf();
 		return *this;
 	}
 
 	int operator - (const IStreamIterator& o) const
 	{
-		return (int)m_readpos - o.m_readpos;
+		return (int)(position() - o.position());
 	}
 
 	PositionIndex position() const
 	{
-		return m_abspos + m_readpos;
+		return m_win?(m_win->abspos + (m_itr - m_win->buf)):0;
+	}
+
+	/// \brief Get the pointer to the current character in the window (for bulk scanning)
+	inline const char* windowBegin() const
+	{
+		return m_itr;
+	}
+
+	/// \brief Get the pointer to the end of the window (for bulk scanning)
+	inline const char* windowEnd() const
+	{
+		return m_end;
+	}
+
+	/// \brief Skip a number of characters at once and refill the window if its end is reached (for bulk scanning)
+	/// \param [in] n number of characters to skip, must not exceed the end of the window
+	inline void windowAdvance( std::size_t n)
+	{
+		if ((m_itr += n) >= m_end) fillbuf();
 	}
 
 private:
-	bool fillbuf()
+	/// \brief Get the window of an iterator without input (a null byte for the end of input)
+	static const char* emptyWindow()
 	{
-		m_abspos += m_readsize;
-		m_readsize = m_input->read( m_buf, m_bufsize);
-		m_readpos = 0;
-		if (m_input->errorcode()) throw exception( FileReadError);
-		return true;
+		return "";
+	}
+
+	void fillbuf()
+	{
+		if (m_itr < m_end) return;
+		if (!m_win)
+		{
+			m_itr = m_end = emptyWindow();
+			return;
+		}
+		m_win->abspos += m_win->readsize;
+		m_win->readsize = m_win->input->read( m_win->buf, m_win->bufsize);
+		m_win->buf[ m_win->readsize] = 0;
+		m_itr = m_win->buf;
+		m_end = m_win->buf + m_win->readsize;
+		if (m_win->input->errorcode()) throw exception( FileReadError);
+	}
+
+	void release()
+	{
+		if (m_win && --m_win->refcnt == 0)
+		{
+			std::free( m_win->buf);
+			std::free( m_win);
+		}
+		m_win = 0;
 	}
 
 private:
-	IStream* m_input;
-	char* m_buf;
-	std::size_t m_bufsize;
-	std::size_t m_readsize;
-	std::size_t m_readpos;
-	PositionIndex m_abspos;
+	Window* m_win;			///< window shared by all copies of the iterator
+	const char* m_itr;		///< current character in the window
+	const char* m_end;		///< end of the window
 };
 
 }//namespace
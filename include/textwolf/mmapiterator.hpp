@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \file textwolf/mmapiterator.hpp
+/// \brief Definition of iterators for textwolf on memory mapped files
+
+#ifndef __TEXTWOLF_MMAP_ITERATOR_HPP__
+#define __TEXTWOLF_MMAP_ITERATOR_HPP__
+#include "textwolf/exception.hpp"
+#include "textwolf/position.hpp"
+#include <cstddef>
+#include <string>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/// \namespace textwolf
+/// \brief Toplevel namespace of the library
+namespace textwolf {
+
+/// \class MMapFile
+/// \brief Read only memory mapping of a complete file
+/// \remark The mapping is advised for sequential access, so that the system can read ahead and drop pages already scanned. It has to live as long as the iterators on it.
+class MMapFile
+	:public throws_exception
+{
+public:
+	/// \brief Constructor
+	/// \param [in] path path of the file to map
+	explicit MMapFile( const char* path)
+		:m_ptr(0),m_size(0)
+	{
+		open( path);
+	}
+
+	/// \brief Constructor
+	/// \param [in] path path of the file to map
+	explicit MMapFile( const std::string& path)
+		:m_ptr(0),m_size(0)
+	{
+		open( path.c_str());
+	}
+
+	/// \brief Destructor
+	~MMapFile()
+	{
+		close();
+	}
+
+	/// \brief Get the pointer to the start of the mapped file content
+	const char* ptr() const		{return m_ptr;}
+	/// \brief Get the size of the mapped file in bytes
+	PositionIndex size() const	{return m_size;}
+
+private:
+	MMapFile( const MMapFile&){}		//non copyable
+	void operator=( const MMapFile&){}	//non copyable
+
+#if defined(_WIN32)
+	void open( const char* path)
+	{
+		HANDLE fh = ::CreateFileA( path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (fh == INVALID_HANDLE_VALUE) throw exception( FileReadError);
+		LARGE_INTEGER fs;
+		if (!::GetFileSizeEx( fh, &fs))
+		{
+			::CloseHandle( fh);
+			throw exception( FileReadError);
+		}
+		m_size = (PositionIndex)fs.QuadPart;
+		if (m_size)
+		{
+			HANDLE mh = ::CreateFileMappingA( fh, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (mh)
+			{
+				m_ptr = (const char*)::MapViewOfFile( mh, FILE_MAP_READ, 0, 0, 0);
+				::CloseHandle( mh);
+			}
+		}
+		::CloseHandle( fh);
+		if (m_size && !m_ptr) throw exception( FileReadError);
+	}
+
+	void close()
+	{
+		if (m_ptr) ::UnmapViewOfFile( m_ptr);
+		m_ptr = 0;
+	}
+#else
+	void open( const char* path)
+	{
+		int fd = ::open( path, O_RDONLY);
+		if (fd < 0) throw exception( FileReadError);
+		struct stat st;
+		if (::fstat( fd, &st) != 0)
+		{
+			::close( fd);
+			throw exception( FileReadError);
+		}
+		m_size = (PositionIndex)st.st_size;
+		if (m_size)
+		{
+			void* mm = ::mmap( 0, (std::size_t)m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mm != MAP_FAILED)
+			{
+				m_ptr = (const char*)mm;
+				::madvise( mm, (std::size_t)m_size, MADV_SEQUENTIAL);
+			}
+		}
+		::close( fd);
+		if (m_size && !m_ptr) throw exception( FileReadError);
+	}
+
+	void close()
+	{
+		if (m_ptr) ::munmap( (void*)m_ptr, (std::size_t)m_size);
+		m_ptr = 0;
+	}
+#endif
+
+private:
+	const char* m_ptr;		///< start of the mapped file content
+	PositionIndex m_size;		///< size of the mapped file in bytes
+};
+
+
+/// \class MMapIterator
+/// \brief Input iterator on a memory mapped file returning null characters after EOF as required by textwolf scanners
+class MMapIterator
+{
+public:
+	/// \brief Default constructor
+	MMapIterator()
+		:m_start(0),m_itr(0),m_end(0){}
+
+	/// \brief Constructor
+	/// \param [in] file memory mapped file to iterate on
+	explicit MMapIterator( const MMapFile& file)
+		:m_start(file.ptr()),m_itr(file.ptr()),m_end(file.ptr()+(std::size_t)file.size()){}
+
+	/// \brief Copy constructor
+	/// \param [in] o iterator to copy
+	MMapIterator( const MMapIterator& o)
+		:m_start(o.m_start),m_itr(o.m_itr),m_end(o.m_end){}
+
+	/// \brief Element access
+	/// \return current character
+	inline char operator* ()
+	{
+		return (m_itr < m_end)?*m_itr:0;
+	}
+
+	/// \brief Preincrement
+	inline MMapIterator& operator++()
+	{
+		++m_itr;
+		return *this;
+	}
+
+	inline int operator - (const MMapIterator& o) const
+	{
+		return (int)(m_itr - o.m_itr);
+	}
+
+	/// \brief Get the absolute position of the current character in the file
+	inline PositionIndex position() const
+	{
+		return (PositionIndex)(m_itr - m_start);
+	}
+
+	/// \brief Get the pointer to the current character in the file (for bulk scanning)
+	inline const char* windowBegin() const
+	{
+		return m_itr;
+	}
+
+	/// \brief Get the pointer to the end of the file (for bulk scanning)
+	inline const char* windowEnd() const
+	{
+		return m_end;
+	}
+
+	/// \brief Skip a number of characters at once (for bulk scanning)
+	/// \param [in] n number of characters to skip, must not exceed the end of the file
+	inline void windowAdvance( std::size_t n)
+	{
+		m_itr += n;
+	}
+
+private:
+	const char* m_start;
+	const char* m_itr;
+	const char* m_end;
+};
+
+}//namespace
+#endif
@@ -0,0 +1,526 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \file textwolf/scannerfactory.hpp
+/// \brief Detection of the character set encoding of an XML document and creation of the XML scanner specialized for it
+
+#ifndef __TEXTWOLF_SCANNER_FACTORY_HPP__
+#define __TEXTWOLF_SCANNER_FACTORY_HPP__
+#include "textwolf/exception.hpp"
+#include "textwolf/charset.hpp"
+#include "textwolf/entitymap.hpp"
+#include "textwolf/sourceiterator.hpp"
+#include "textwolf/xmlscanner.hpp"
+#include <cstddef>
+#include <string>
+
+/// \namespace textwolf
+/// \brief Toplevel namespace of the library
+namespace textwolf {
+
+/// \class XMLEncoding
+/// \brief Character set encoding of an XML document detected from its byte order mark and its XML header
+struct XMLEncoding
+	:public throws_exception
+{
+	/// \enum Id
+	/// \brief Enumeration of the character set encodings supported
+	enum Id
+	{
+		UTF8,		///< UTF-8 (also US-ASCII and the default if nothing is specified)
+		IsoLatin,	///< IsoLatin-1,..IsoLatin-9 with the code page index in codePage
+		UTF16LE,	///< UTF-16 little endian
+		UTF16BE,	///< UTF-16 big endian
+		UCS2LE,		///< UCS-2 little endian
+		UCS2BE,		///< UCS-2 big endian
+		UCS4LE,		///< UCS-4 little endian
+		UCS4BE		///< UCS-4 big endian
+	};
+	enum {NofIds=8};
+
+	/// \brief Get the name of an encoding identifier
+	static const char* idName( Id i)
+	{
+		static const char* ar[] = {"UTF-8","IsoLatin","UTF-16LE","UTF-16BE","UCS-2LE","UCS-2BE","UCS-4LE","UCS-4BE"};
+		return ar[ (int)i];
+	}
+
+	Id id;			///< encoding identifier
+	unsigned int codePage;	///< IsoLatin code page index (1 for "IsoLatin-1"), 0 for other encodings
+	std::size_t bomSize;	///< size of the byte order mark in bytes (0 if there is none)
+
+	/// \brief Default constructor (UTF-8 without byte order mark)
+	XMLEncoding()
+		:id(UTF8),codePage(0),bomSize(0){}
+
+	/// \brief Detect the encoding of an XML document
+	/// \remark The byte order mark or the byte pattern of the first '<' decides about the size and byte order of the characters, the encoding attribute of the XML header about the encoding. The source is not copied, the header has to be complete in the block passed to be considered.
+	/// \param [in] src pointer to the start of the document
+	/// \param [in] srcsize size of the block passed in bytes
+	/// \return the encoding detected
+	static XMLEncoding detect( const char* src, std::size_t srcsize)
+	{
+		XMLEncoding rt;
+		const unsigned char* cc = (const unsigned char*)src;
+		unsigned int unitSize = 1;
+		bool bigEndian = false;
+
+		if (srcsize >= 3 && cc[0] == 0xEF && cc[1] == 0xBB && cc[2] == 0xBF)
+		{
+			rt.bomSize = 3;
+		}
+		else if (srcsize >= 4 && cc[0] == 0xFF && cc[1] == 0xFE && cc[2] == 0 && cc[3] == 0)
+		{
+			rt.bomSize = 4; unitSize = 4;
+		}
+		else if (srcsize >= 4 && cc[0] == 0 && cc[1] == 0 && cc[2] == 0xFE && cc[3] == 0xFF)
+		{
+			rt.bomSize = 4; unitSize = 4; bigEndian = true;
+		}
+		else if (srcsize >= 2 && cc[0] == 0xFF && cc[1] == 0xFE)
+		{
+			rt.bomSize = 2; unitSize = 2;
+		}
+		else if (srcsize >= 2 && cc[0] == 0xFE && cc[1] == 0xFF)
+		{
+			rt.bomSize = 2; unitSize = 2; bigEndian = true;
+		}
+		else if (srcsize >= 4 && cc[0] == 0 && cc[1] == 0 && cc[2] == 0 && cc[3] == '<')
+		{
+			unitSize = 4; bigEndian = true;
+		}
+		else if (srcsize >= 4 && cc[0] == '<' && cc[1] == 0 && cc[2] == 0 && cc[3] == 0)
+		{
+			unitSize = 4;
+		}
+		else if (srcsize >= 2 && cc[0] == 0 && cc[1] == '<')
+		{
+			unitSize = 2; bigEndian = true;
+		}
+		else if (srcsize >= 2 && cc[0] == '<' && cc[1] == 0)
+		{
+			unitSize = 2;
+		}
+		HeaderText hdr( src + rt.bomSize, srcsize - rt.bomSize, unitSize, bigEndian);
+		std::size_t namestart = 0, nameend = 0;
+		bool hasName = headerEncoding( hdr, namestart, nameend) && namestart < nameend;
+		NameCursor<HeaderText> name( hdr, namestart, nameend);
+		switch (unitSize)
+		{
+			case 1:
+				// ... a UTF-8 byte order mark overrides the encoding attribute
+				if (!rt.bomSize && hasName && !parseByteEncodingName( name, rt.id, rt.codePage))
+				{
+					throw exception( EncodingNotSupported);
+				}
+				break;
+			case 2:
+				if (NameCursor<HeaderText>( name).consume( "UCS2") || isName( name, "ISO10646UCS2"))
+				{
+					rt.id = bigEndian?UCS2BE:UCS2LE;
+				}
+				else
+				{
+					rt.id = bigEndian?UTF16BE:UTF16LE;
+				}
+				break;
+			case 4:
+				rt.id = bigEndian?UCS4BE:UCS4LE;
+				break;
+		}
+		return rt;
+	}
+
+	/// \brief Map the name of a single byte based character set encoding to its identifier
+	/// \param [in] name name of the encoding as in the XML header (e.g. "UTF-8", "ISO-8859-1", "IsoLatin-2")
+	/// \param [out] id_ encoding identifier
+	/// \param [out] codePage_ IsoLatin code page index or 0
+	/// \return true on success, false if the encoding is not known
+	static bool parseByteEncodingName( const std::string& name, Id& id_, unsigned int& codePage_)
+	{
+		return parseByteEncodingName( NameCursor<std::string>( name, 0, name.size()), id_, codePage_);
+	}
+
+private:
+	/// \class HeaderText
+	/// \brief View on the characters of the start of a document in units of 1, 2 or 4 bytes, read in place
+	class HeaderText
+	{
+	public:
+		/// \brief Constructor
+		/// \param [in] src_ pointer to the start of the document after the byte order mark
+		/// \param [in] srcsize_ size of the block in bytes
+		/// \param [in] unitSize_ size of a character in bytes
+		/// \param [in] bigEndian_ true, if the bytes of a character are in big endian order
+		HeaderText( const char* src_, std::size_t srcsize_, unsigned int unitSize_, bool bigEndian_)
+			:m_src((const unsigned char*)src_),m_size(srcsize_/unitSize_),m_unitSize(unitSize_),m_bigEndian(bigEndian_){}
+
+		/// \brief Get the number of characters
+		std::size_t size() const
+		{
+			return m_size;
+		}
+
+		/// \brief Get a character (only ASCII characters are of interest in the header)
+		/// \param [in] pos index of the character
+		/// \return the ASCII character or 0 for a null or a non ASCII character
+		char operator[]( std::size_t pos) const
+		{
+			const unsigned char* cc = m_src + pos * m_unitSize;
+			unsigned char rt = 0;
+			for (unsigned int ii = 0; ii < m_unitSize; ++ii)
+			{
+				unsigned char bb = cc[ m_bigEndian ? (m_unitSize-1-ii) : ii];
+				if (ii == 0) rt = bb; else if (bb) return 0;
+			}
+			return (rt >= 0x80) ? 0 : (char)rt;
+		}
+
+	private:
+		const unsigned char* m_src;	///< start of the document after the byte order mark
+		std::size_t m_size;		///< number of characters
+		unsigned int m_unitSize;	///< size of a character in bytes
+		bool m_bigEndian;		///< true, if the bytes of a character are in big endian order
+	};
+
+	/// \class NameCursor
+	/// \brief Iterator on the characters of an encoding name normalized for comparison (upper case without '-','_' and spaces)
+	/// \tparam Text random access sequence of characters (std::string or HeaderText)
+	template <class Text>
+	class NameCursor
+	{
+	public:
+		/// \brief Constructor
+		/// \param [in] txt_ text with the name
+		/// \param [in] pos_ index of the first character of the name
+		/// \param [in] end_ index of the end of the name
+		NameCursor( const Text& txt_, std::size_t pos_, std::size_t end_)
+			:m_txt(&txt_),m_pos(pos_),m_end(end_)
+		{
+			skip();
+		}
+
+		/// \brief Get the current character or 0 at the end of the name
+		char chr() const
+		{
+			if (m_pos == m_end) return 0;
+			char ch = (*m_txt)[ m_pos];
+			return (ch >= 'a' && ch <= 'z') ? (ch - 'a' + 'A') : ch;
+		}
+
+		/// \brief Skip to the next character
+		void next()
+		{
+			++m_pos;
+			skip();
+		}
+
+		/// \brief Find out if the end of the name has been reached
+		bool end() const
+		{
+			return m_pos == m_end;
+		}
+
+		/// \brief Skip a prefix of the name if it matches, otherwise stay
+		/// \param [in] prefix the prefix in normalized form
+		/// \return true, if the prefix matched
+		bool consume( const char* prefix)
+		{
+			NameCursor start( *this);
+			for (; *prefix; ++prefix, next())
+			{
+				if (chr() != *prefix)
+				{
+					*this = start;
+					return false;
+				}
+			}
+			return true;
+		}
+
+	private:
+		void skip()
+		{
+			while (m_pos < m_end && ((*m_txt)[ m_pos] == '-' || (*m_txt)[ m_pos] == '_' || (*m_txt)[ m_pos] == ' ')) ++m_pos;
+		}
+
+	private:
+		const Text* m_txt;		///< text with the name
+		std::size_t m_pos;		///< index of the current character
+		std::size_t m_end;		///< index of the end of the name
+	};
+
+	/// \brief Find out if an encoding name is equal to a name in normalized form
+	template <class Text>
+	static bool isName( NameCursor<Text> nn, const char* name)
+	{
+		return nn.consume( name) && nn.end();
+	}
+
+	/// \brief Map the name of a single byte based character set encoding to its identifier
+	template <class Text>
+	static bool parseByteEncodingName( NameCursor<Text> nn, Id& id_, unsigned int& codePage_)
+	{
+		if (isName( nn, "UTF8") || isName( nn, "USASCII") || isName( nn, "ASCII"))
+		{
+			id_ = UTF8;
+			codePage_ = 0;
+			return true;
+		}
+		bool iso8859 = false;
+		if (nn.consume( "ISO8859"))
+		{
+			iso8859 = true;
+		}
+		else if (!nn.consume( "ISOLATIN") && !nn.consume( "LATIN"))
+		{
+			return false;
+		}
+		unsigned int number = 0;
+		if (nn.end()) number = 1;
+		for (; nn.chr() >= '0' && nn.chr() <= '9' && number < 100; nn.next()) number = number * 10 + (nn.chr() - '0');
+		if (!nn.end()) return false;
+		if (iso8859)
+		{
+			// ... ISO-8859 part numbers of the IsoLatin code pages 1..9
+			static const unsigned int part[ 10] = {0,1,2,3,4,9,10,13,14,15};
+			unsigned int ii = 1;
+			for (; ii < 10 && part[ ii] != number; ++ii){}
+			number = ii;
+		}
+		if (number == 0 || number > 9) return false;
+		id_ = IsoLatin;
+		codePage_ = number;
+		return true;
+	}
+
+	/// \brief Find out if a string is at a position of the header
+	static bool matches( const HeaderText& hdr, std::size_t pos, std::size_t end, const char* str)
+	{
+		for (; *str; ++str, ++pos)
+		{
+			if (pos == end || hdr[ pos] != *str) return false;
+		}
+		return true;
+	}
+
+	/// \brief Skip the spaces at a position of the header
+	static std::size_t skipSpaces( const HeaderText& hdr, std::size_t pos, std::size_t end)
+	{
+		for (; pos < end && (hdr[ pos] == ' ' || hdr[ pos] == '\t' || hdr[ pos] == '\r' || hdr[ pos] == '\n'); ++pos){}
+		return pos;
+	}
+
+	/// \brief Locate the value of the encoding attribute of the XML header at the start of a block
+	/// \param [in] hdr the start of the document after the byte order mark
+	/// \param [out] namestart index of the first character of the encoding attribute value
+	/// \param [out] nameend index of the end of the encoding attribute value
+	/// \return true, if the encoding is specified in a complete header, false if not
+	static bool headerEncoding( const HeaderText& hdr, std::size_t& namestart, std::size_t& nameend)
+	{
+		enum {MaxHeaderSize=1024};
+		std::size_t size = (hdr.size() < MaxHeaderSize) ? hdr.size() : (std::size_t)MaxHeaderSize;
+		std::size_t end = 0;
+		for (; end < size && hdr[ end] != '>'; ++end)
+		{
+			if (!hdr[ end]) return false;
+		}
+		if (end == size) return false;
+
+		std::size_t pos = skipSpaces( hdr, 0, end);
+		if (!matches( hdr, pos, end, "<?xml")) return false;
+		for (pos += 5; pos < end && !matches( hdr, pos, end, "encoding"); ++pos){}
+		if (pos == end) return false;
+		pos = skipSpaces( hdr, pos + 8, end);
+		if (pos == end || hdr[ pos] != '=') return false;
+		pos = skipSpaces( hdr, pos + 1, end);
+		if (pos == end || (hdr[ pos] != '"' && hdr[ pos] != '\'')) return false;
+		char quote = hdr[ pos];
+		namestart = ++pos;
+		for (; pos < end && hdr[ pos] != quote; ++pos){}
+		if (pos == end) return false;
+		nameend = pos;
+		return true;
+	}
+};
+
+
+/// \class ScannerFactory
+/// \brief Factory for XML scanners on a memory block or on chunks fed (SrcIterator) specialized for the character set encoding detected in the source
+/// \tparam OutputCharSet_ character set encoding of the elements returned by the scanner
+/// \tparam OutputBuffer_ type of the buffer for the elements returned by the scanner
+template <class OutputCharSet_=charset::UTF8, class OutputBuffer_=std::string>
+class ScannerFactory
+{
+public:
+	typedef OutputCharSet_ OutputCharSet;
+	typedef OutputBuffer_ OutputBuffer;
+	typedef XMLScannerBase::ElementType ElementType;
+	typedef XMLScannerBase::Error Error;
+	typedef XMLScannerBase::EventBatch EventBatch;
+
+private:
+	/// \class ScannerBase
+	/// \brief Interface of the scanners instantiated for the different encodings
+	struct ScannerBase
+	{
+		virtual ~ScannerBase(){}
+		virtual ScannerBase* copy() const=0;
+		virtual void feed( const char* chunk, std::size_t chunksize, bool eof)=0;
+		virtual bool setZeroCopy( bool enable)=0;
+		virtual ElementType nextItem( unsigned short mask)=0;
+		virtual std::size_t nextItems( EventBatch& batch, std::size_t maxCount, unsigned short mask)=0;
+		virtual const char* getItemPtr() const=0;
+		virtual std::size_t getItemSize() const=0;
+		virtual std::size_t getTokenPosition() const=0;
+		virtual Error getError( const char** str)=0;
+	};
+
+	/// \class ScannerImpl
+	/// \brief Scanner instantiated for the encoding InputCharSet
+	template <class InputCharSet>
+	struct ScannerImpl
+		:public ScannerBase
+	{
+		typedef XMLScanner<SrcIterator,InputCharSet,OutputCharSet,OutputBuffer> ThisXMLScanner;
+		ThisXMLScanner scanner;
+
+		ScannerImpl( const InputCharSet& charset, const SrcIterator& src, const EntityMap* entityMap)
+			:scanner( entityMap ? ThisXMLScanner( charset, src, *entityMap) : ThisXMLScanner( charset, src)){}
+		ScannerImpl( const ScannerImpl& o)
+			:ScannerBase(),scanner(o.scanner){}
+
+		virtual ScannerBase* copy() const						{return new ScannerImpl( *this);}
+		virtual void feed( const char* chunk, std::size_t chunksize, bool eof)		{scanner.feed( chunk, chunksize, eof);}
+		virtual bool setZeroCopy( bool enable)						{return scanner.setZeroCopy( enable);}
+		virtual ElementType nextItem( unsigned short mask)				{return scanner.nextItem( mask);}
+		virtual std::size_t nextItems( EventBatch& batch, std::size_t maxCount, unsigned short mask)	{return scanner.nextItems( batch, maxCount, mask);}
+		virtual const char* getItemPtr() const						{return scanner.getItemPtr();}
+		virtual std::size_t getItemSize() const						{return scanner.getItemSize();}
+		virtual std::size_t getTokenPosition() const					{return scanner.getTokenPosition();}
+		virtual Error getError( const char** str)					{return scanner.getError( str);}
+	};
+
+public:
+	/// \class Scanner
+	/// \brief Handle to an XML scanner specialized for the encoding of its source with the type of the scanner erased
+	/// \remark The scanning methods of the handle cost a virtual call per element. For the full speed of the specialized scanner use visit(Visitor&), that dispatches only once.
+	class Scanner
+	{
+	public:
+		/// \brief Copy constructor
+		Scanner( const Scanner& o)
+			:m_encoding(o.m_encoding),m_impl(o.m_impl->copy()){}
+		/// \brief Destructor
+		~Scanner()
+		{
+			delete m_impl;
+		}
+		/// \brief Assignment operator
+		Scanner& operator=( const Scanner& o)
+		{
+			ScannerBase* impl = o.m_impl->copy();
+			delete m_impl;
+			m_impl = impl;
+			m_encoding = o.m_encoding;
+			return *this;
+		}
+
+		/// \brief Get the encoding of the source detected
+		const XMLEncoding& encoding() const					{return m_encoding;}
+
+		/// \brief See XMLScanner::feed(const char*,std::size_t,bool)
+		void feed( const char* chunk, std::size_t chunksize, bool eof=false)	{m_impl->feed( chunk, chunksize, eof);}
+		/// \brief See XMLScanner::setZeroCopy(bool)
+		bool setZeroCopy( bool enable=true)					{return m_impl->setZeroCopy( enable);}
+		/// \brief See XMLScanner::nextItem(unsigned short)
+		ElementType nextItem( unsigned short mask=0xFFFF)			{return m_impl->nextItem( mask);}
+		/// \brief See XMLScanner::nextItems(EventBatch&,std::size_t,unsigned short)
+		std::size_t nextItems( EventBatch& batch, std::size_t maxCount, unsigned short mask=0xFFFF)	{return m_impl->nextItems( batch, maxCount, mask);}
+		/// \brief See XMLScanner::getItemPtr()
+		const char* getItemPtr() const						{return m_impl->getItemPtr();}
+		/// \brief See XMLScanner::getItemSize()
+		std::size_t getItemSize() const					{return m_impl->getItemSize();}
+		/// \brief See XMLScanner::getTokenPosition(), the position is relative to the end of the byte order mark
+		std::size_t getTokenPosition() const					{return m_impl->getTokenPosition();}
+		/// \brief See XMLScanner::getError(const char**)
+		Error getError( const char** str=0)					{return m_impl->getError( str);}
+
+		/// \brief Call a visitor with the scanner specialized for the encoding detected
+		/// \remark The visitor has to implement a template operator()(XMLScanner<SrcIterator,InputCharSet,OutputCharSet,OutputBuffer>&) for any InputCharSet. It is called once with the scanner, so that the scanning loop in the visitor runs with the full speed of the specialized template.
+		/// \param [in,out] visitor visitor to call
+		template <class Visitor>
+		void visit( Visitor& visitor)
+		{
+			switch (m_encoding.id)
+			{
+				case XMLEncoding::UTF8:		visitor( impl<charset::UTF8>().scanner); break;
+				case XMLEncoding::IsoLatin:	visitor( impl<charset::IsoLatin>().scanner); break;
+				case XMLEncoding::UTF16LE:	visitor( impl<charset::UTF16LE>().scanner); break;
+				case XMLEncoding::UTF16BE:	visitor( impl<charset::UTF16BE>().scanner); break;
+				case XMLEncoding::UCS2LE:	visitor( impl<charset::UCS2LE>().scanner); break;
+				case XMLEncoding::UCS2BE:	visitor( impl<charset::UCS2BE>().scanner); break;
+				case XMLEncoding::UCS4LE:	visitor( impl<charset::UCS4LE>().scanner); break;
+				case XMLEncoding::UCS4BE:	visitor( impl<charset::UCS4BE>().scanner); break;
+			}
+		}
+
+	private:
+		friend class ScannerFactory;
+		Scanner( const XMLEncoding& encoding_, ScannerBase* impl_)
+			:m_encoding(encoding_),m_impl(impl_){}
+
+		template <class InputCharSet>
+		ScannerImpl<InputCharSet>& impl()
+		{
+			return *static_cast<ScannerImpl<InputCharSet>*>( m_impl);
+		}
+
+	private:
+		XMLEncoding m_encoding;		///< encoding detected
+		ScannerBase* m_impl;		///< scanner specialized for the encoding
+	};
+
+	/// \brief Create a scanner for a document after detecting its encoding (see XMLEncoding::detect(const char*,std::size_t))
+	/// \param [in] src pointer to the document or its first chunk, it has to contain the byte order mark and the XML header if there are any
+	/// \param [in] srcsize size of the block passed in bytes
+	/// \param [in] eof true, if the block contains the complete document, false if more chunks follow (see Scanner::feed(const char*,std::size_t,bool))
+	/// \param [in] entityMap map of user defined entities or NULL
+	/// \return the handle to the scanner positioned after the byte order mark
+	static Scanner create( const char* src, std::size_t srcsize, bool eof=true, const EntityMap* entityMap=0)
+	{
+		return create( XMLEncoding::detect( src, srcsize), src, srcsize, eof, entityMap);
+	}
+
+	/// \brief Create a scanner for a document in an encoding known
+	/// \param [in] encoding encoding of the document
+	/// \param [in] src pointer to the document or its first chunk including the byte order mark if there is one (see XMLEncoding::bomSize)
+	/// \param [in] srcsize size of the block passed in bytes
+	/// \param [in] eof true, if the block contains the complete document, false if more chunks follow (see Scanner::feed(const char*,std::size_t,bool))
+	/// \param [in] entityMap map of user defined entities or NULL
+	/// \return the handle to the scanner positioned after the byte order mark
+	static Scanner create( const XMLEncoding& encoding, const char* src, std::size_t srcsize, bool eof=true, const EntityMap* entityMap=0)
+	{
+		SrcIterator itr( src + encoding.bomSize, srcsize - encoding.bomSize, eof?SrcIterator::LastChunk:SrcIterator::PartialChunk);
+		ScannerBase* impl = 0;
+		switch (encoding.id)
+		{
+			case XMLEncoding::UTF8:		impl = new ScannerImpl<charset::UTF8>( charset::UTF8(), itr, entityMap); break;
+			case XMLEncoding::IsoLatin:	impl = new ScannerImpl<charset::IsoLatin>( charset::IsoLatin( encoding.codePage), itr, entityMap); break;
+			case XMLEncoding::UTF16LE:	impl = new ScannerImpl<charset::UTF16LE>( charset::UTF16LE(), itr, entityMap); break;
+			case XMLEncoding::UTF16BE:	impl = new ScannerImpl<charset::UTF16BE>( charset::UTF16BE(), itr, entityMap); break;
+			case XMLEncoding::UCS2LE:	impl = new ScannerImpl<charset::UCS2LE>( charset::UCS2LE(), itr, entityMap); break;
+			case XMLEncoding::UCS2BE:	impl = new ScannerImpl<charset::UCS2BE>( charset::UCS2BE(), itr, entityMap); break;
+			case XMLEncoding::UCS4LE:	impl = new ScannerImpl<charset::UCS4LE>( charset::UCS4LE(), itr, entityMap); break;
+			case XMLEncoding::UCS4BE:	impl = new ScannerImpl<charset::UCS4BE>( charset::UCS4BE(), itr, entityMap); break;
+		}
+		return Scanner( encoding, impl);
+	}
+};
+
+}//namespace
+#endif
@@ -14,7 +14,6 @@
 #include "textwolf/position.hpp"
 #include <cstdlib>
 #include <stdexcept>
-#include <setjmp.h>
 
 /// \namespace textwolf
 /// \brief Toplevel namespace of the library
@@ -22,16 +21,29 @@ namespace textwolf {
 
 /// \class SrcIterator
 /// \brief Input iterator as source for the XML scanner with the possibility of being fed chunk by chunk
+/// \remark If the iterator is fed chunk by chunk, then the scanner checks for the end of a chunk that is not the last one with needMore() before reading the next character (see XMLScanner::feed(const char*,std::size_t,bool)). Only if a character is read beyond it (inside an entity reference, a keyword or a multibyte character split by the end of the chunk), this is signaled with an EndOfChunk exception caught by the scanner.
 class SrcIterator
 	:public throws_exception 
 {
 public:
+	/// \class EndOfChunk
+	/// \brief Exception thrown when the end of a chunk has been reached that is not the end of data
+	struct EndOfChunk {};
+
+	/// \enum ChunkType
+	/// \brief Declares if a chunk passed contains the rest of the input or if more chunks follow
+	enum ChunkType
+	{
+		LastChunk,		///< the chunk contains the complete rest of the input, its end is the end of data
+		PartialChunk		///< more chunks follow, the end of the chunk is not the end of data
+	};
+
 	/// \brief Empty constructor
 	SrcIterator()
 		:m_start(0)
 		,m_itr(0)
 		,m_end(0)
-		,m_eom(0)
+		,m_eom(false)
 		,m_abspos(0){}
 
 	/// \brief Copy constructor
@@ -46,12 +58,12 @@ public:
 	/// \brief Constructor
 	/// \param [in] buf source chunk to iterate on
 	/// \param [in] size size of source chunk to iterate on in bytes
-	/// \param [in] eom_ trigger to activate if end of data has been reached (no next chunk anymore)
-	SrcIterator( const char* buf, std::size_t size, jmp_buf* eom_=0)
+	/// \param [in] type_ declares if the chunk contains the rest of the input or if more chunks follow
+	SrcIterator( const char* buf, std::size_t size, ChunkType type_=LastChunk)
 		:m_start(const_cast<char*>(buf))
 		,m_itr(const_cast<char*>(buf))
 		,m_end(m_itr+size)
-		,m_eom(eom_)
+		,m_eom(type_ == PartialChunk)
 		,m_abspos(size){}
 
 	/// \brief Assingment operator
@@ -70,7 +82,7 @@ public:
 	{
 		if (m_itr >= m_end)
 		{
-			if (m_eom) longjmp(*m_eom,1);
+			if (m_eom) throw EndOfChunk();
 			return 0;
 		}
 		return *m_itr;
@@ -93,13 +105,13 @@ public:
 	/// \brief Feed input to the source iterator
 	/// \param[in] buf poiner to start of input
 	/// \param[in] size size of input passed in bytes
-	/// \param[in] eom longjmp to call with parameter 1, if the end of data has been reached before EOF (null termination), eom=null, if the chunk passed contains the complete reset of the input and eof (null) can be returned if we reach the end
-	void putInput( const char* buf, std::size_t size, jmp_buf* eom=0)
+	/// \param[in] type PartialChunk, if more chunks follow (the end of the chunk is reported by needMore()), LastChunk if the chunk passed contains the complete rest of the input and eof (null) can be returned if we reach the end
+	void putInput( const char* buf, std::size_t size, ChunkType type=LastChunk)
 	{
 		m_abspos += size;
 		m_start = m_itr = const_cast<char*>(buf);
 		m_end = m_itr+size;
-		m_eom = eom;
+		m_eom = (type == PartialChunk);
 	}
 
 	/// \brief Get the current position in the current chunk parsed
@@ -119,11 +131,42 @@ public:
 		return (m_itr >= m_end);
 	}
 
+	/// \brief Find out if the end of a chunk has been reached that is not the end of data, so that more input is needed to continue
+	inline bool needMore() const
+	{
+		return m_eom && m_itr >= m_end;
+	}
+
+	/// \brief Get the pointer to the current character in the chunk (for bulk scanning)
+	inline const char* windowBegin() const
+	{
+		return m_itr;
+	}
+
+	/// \brief Get the pointer to the end of the chunk (for bulk scanning)
+	inline const char* windowEnd() const
+	{
+		return m_end;
+	}
+
+	/// \brief Skip a number of characters at once (for bulk scanning)
+	/// \param [in] n number of characters to skip, must not exceed the end of the chunk
+	inline void windowAdvance( std::size_t n)
+	{
+		m_itr += n;
+	}
+
+	/// \brief Find out if the chunk contains the rest of the input, so that the scanner does not have to leave it before the end
+	inline bool windowStable() const
+	{
+		return !m_eom;
+	}
+
 private:
 	char* m_start;
 	char* m_itr;
 	char* m_end;
-	jmp_buf* m_eom;
+	bool m_eom;
 	PositionIndex m_abspos;
 };
 
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \file textwolf/symboltable.hpp
+/// \brief Table of interned names mapped to small integer identifiers
+
+#ifndef __TEXTWOLF_SYMBOL_TABLE_HPP__
+#define __TEXTWOLF_SYMBOL_TABLE_HPP__
+#include "textwolf/exception.hpp"
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <new>
+
+namespace textwolf {
+
+/// \class SymbolTable
+/// \brief Dictionary of byte strings (tag names, attribute names and values) interned as integer identifiers, implemented as hash table with open addressing
+/// \remark The identifiers are assigned in ascending order starting with 1, 0 stands for an undefined symbol. The keys of an XMLPathSelectAutomaton are interned at definition, so that a scanner or a selector resolves a name once with one hash lookup and compares integers afterwards. A symbol table is read only after its definition and can be shared by any number of scanners and selectors, also in different threads.
+class SymbolTable :public throws_exception
+{
+public:
+	/// \brief Default constructor (empty table)
+	SymbolTable()
+		:m_mask(0),m_maxkeysize(0)
+	{
+		m_keyofs.push_back( 0);
+	}
+
+	/// \brief Get the identifier of a symbol
+	/// \param [in] key pointer to the symbol
+	/// \param [in] keysize size of the symbol in bytes
+	/// \return the identifier or 0, if the symbol is not defined
+	int get( const char* key, std::size_t keysize) const
+	{
+		if (keysize > m_maxkeysize || m_hashtab.empty()) return 0;
+		unsigned int hh = hash( key, keysize);
+		for (unsigned int ei = hh & m_mask;; ei = (ei + 1) & m_mask)
+		{
+			const Entry& entry = m_hashtab[ ei];
+			if (entry.id == 0) return 0;
+			if (entry.hash == hh && equal( entry.id, key, keysize)) return entry.id;
+		}
+	}
+
+	/// \brief Get the identifier of a symbol, define it if it does not exist yet
+	/// \param [in] key pointer to the symbol
+	/// \param [in] keysize size of the symbol in bytes
+	/// \return the identifier
+	int insert( const char* key, std::size_t keysize)
+	{
+		int rt = get( key, keysize);
+		if (rt) return rt;
+		try
+		{
+			if ((size() + 1) * 2 > m_hashtab.size()) rehash( m_hashtab.empty() ? 16 : m_hashtab.size() * 2);
+			m_strings.append( key, keysize);
+			m_keyofs.push_back( m_strings.size());
+			if (keysize > m_maxkeysize) m_maxkeysize = keysize;
+			rt = (int)size();
+			insertEntry( hash( key, keysize), rt);
+			return rt;
+		}
+		catch (const std::bad_alloc&)
+		{
+			throw exception( OutOfMem);
+		}
+	}
+
+	/// \brief Get the number of symbols defined
+	/// \return the number of symbols
+	std::size_t size() const
+	{
+		return m_keyofs.size() - 1;
+	}
+
+	/// \brief Get the string of a symbol
+	/// \param [in] id identifier of the symbol (1..size())
+	/// \return pointer to the symbol (not null terminated)
+	const char* key( int id) const
+	{
+		return m_strings.data() + m_keyofs[ id-1];
+	}
+
+	/// \brief Get the size of the string of a symbol
+	/// \param [in] id identifier of the symbol (1..size())
+	/// \return the size of the symbol in bytes
+	std::size_t keysize( int id) const
+	{
+		return m_keyofs[ id] - m_keyofs[ id-1];
+	}
+
+private:
+	/// \class Entry
+	/// \brief Entry of the hash table
+	struct Entry
+	{
+		unsigned int hash;		///< hash value of the symbol
+		int id;				///< identifier of the symbol or 0 for an empty entry
+
+		Entry()	:hash(0),id(0){}
+	};
+
+	/// \brief Hash function (FNV-1a)
+	static unsigned int hash( const char* key, std::size_t keysize)
+	{
+		unsigned int rt = 2166136261U;
+		for (std::size_t ii=0; ii<keysize; ++ii)
+		{
+			rt = (rt ^ (unsigned char)key[ ii]) * 16777619U;
+		}
+		return rt ^ (rt >> 15);
+	}
+
+	bool equal( int id, const char* key, std::size_t keysize) const
+	{
+		return keysize == this->keysize( id) && std::memcmp( this->key( id), key, keysize) == 0;
+	}
+
+	void insertEntry( unsigned int hh, int id)
+	{
+		unsigned int ei = hh & m_mask;
+		while (m_hashtab[ ei].id != 0) ei = (ei + 1) & m_mask;
+		m_hashtab[ ei].hash = hh;
+		m_hashtab[ ei].id = id;
+	}
+
+	void rehash( std::size_t tabsize)
+	{
+		std::vector<Entry> old;
+		old.swap( m_hashtab);
+		m_hashtab.resize( tabsize);
+		m_mask = tabsize - 1;
+		std::vector<Entry>::const_iterator oi = old.begin(), oe = old.end();
+		for (; oi != oe; ++oi)
+		{
+			if (oi->id) insertEntry( oi->hash, oi->id);
+		}
+	}
+
+private:
+	std::vector<Entry> m_hashtab;		///< hash table (size is a power of two)
+	unsigned int m_mask;			///< size of the hash table minus one
+	std::string m_strings;			///< the symbols concatenated
+	std::vector<std::size_t> m_keyofs;	///< end of the symbol with identifier i in m_strings at index i, start at index i-1
+	std::size_t m_maxkeysize;		///< size of the longest symbol, longer keys are rejected without hashing
+};
+
+}//namespace
+#endif
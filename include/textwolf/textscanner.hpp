@@ -16,7 +16,16 @@
 #include "textwolf/sourceiterator.hpp"
 #include "textwolf/istreamiterator.hpp"
 #include "textwolf/cstringiterator.hpp"
+#include "textwolf/mmapiterator.hpp"
+#include "textwolf/charset_utf8.hpp"
+#include "textwolf/charset_isolatin.hpp"
+#include "textwolf/charset_utf16.hpp"
+#include "textwolf/staticbuffer.hpp"
+#include "textwolf/arenabuffer.hpp"
+#include "textwolf/bytescan.hpp"
+#include "textwolf/utf8block.hpp"
 #include <cstddef>
+#include <string>
 
 namespace textwolf {
 
@@ -59,6 +68,262 @@ struct Traits<CStringIterator>
 	}
 };
 
+template <>
+struct Traits<MMapIterator>
+{
+	static inline std::size_t getPosition( const MMapIterator&, const MMapIterator& itr)
+	{
+		return (std::size_t)itr.position();
+	}
+};
+
+/// \class WindowTraits
+/// \brief Access to the contiguous memory block (window) of the source a source iterator is currently pointing into
+/// \remark Used for bulk scanning. Iterators without specialization are scanned character by character.
+template <typename Iterator>
+struct WindowTraits
+{
+	enum {Enabled=0};
+	/// \brief Get the pointer to the current character
+	static inline const char* begin( const Iterator&)		{return 0;}
+	/// \brief Get the pointer to the end of the window or NULL if the window is null terminated
+	static inline const char* end( const Iterator&)		{return 0;}
+	/// \brief Skip a number of bytes inside the window
+	static inline void advance( Iterator&, std::size_t)		{}
+	/// \brief Find out if the window memory stays valid until the end of the scan (pointers into it can be handed out as element content)
+	static inline bool stable( const Iterator&)			{return false;}
+};
+
+template <>
+struct WindowTraits<char*>
+{
+	enum {Enabled=1};
+	static inline const char* begin( char* const& itr)		{return itr;}
+	static inline const char* end( char* const&)			{return 0;}
+	static inline void advance( char*& itr, std::size_t n)		{itr += n;}
+	static inline bool stable( char* const&)			{return true;}
+};
+
+template <>
+struct WindowTraits<SrcIterator>
+{
+	enum {Enabled=1};
+	static inline const char* begin( const SrcIterator& itr)	{return itr.windowBegin();}
+	static inline const char* end( const SrcIterator& itr)		{return itr.windowEnd();}
+	static inline void advance( SrcIterator& itr, std::size_t n)	{itr.windowAdvance( n);}
+	static inline bool stable( const SrcIterator& itr)		{return itr.windowStable();}
+};
+
+template <>
+struct WindowTraits<IStreamIterator>
+{
+	enum {Enabled=1};
+	static inline const char* begin( const IStreamIterator& itr)	{return itr.windowBegin();}
+	static inline const char* end( const IStreamIterator& itr)	{return itr.windowEnd();}
+	static inline void advance( IStreamIterator& itr, std::size_t n){itr.windowAdvance( n);}
+	static inline bool stable( const IStreamIterator&)		{return false;}
+};
+
+template <>
+struct WindowTraits<CStringIterator>
+{
+	enum {Enabled=1};
+	static inline const char* begin( const CStringIterator& itr)	{return itr.windowBegin();}
+	static inline const char* end( const CStringIterator& itr)	{return itr.windowEnd();}
+	static inline void advance( CStringIterator& itr, std::size_t n){itr.windowAdvance( n);}
+	static inline bool stable( const CStringIterator&)		{return true;}
+};
+
+template <>
+struct WindowTraits<MMapIterator>
+{
+	enum {Enabled=1};
+	static inline const char* begin( const MMapIterator& itr)	{return itr.windowBegin();}
+	static inline const char* end( const MMapIterator& itr)		{return itr.windowEnd();}
+	static inline void advance( MMapIterator& itr, std::size_t n)	{itr.windowAdvance( n);}
+	static inline bool stable( const MMapIterator&)			{return true;}
+};
+
+/// \class ChunkTraits
+/// \brief Access to the end of chunk status of a source iterator fed chunk by chunk (see XMLScanner::feed(const char*,std::size_t,bool))
+/// \remark Iterators without specialization are never at the end of a chunk that is not the end of data
+template <typename Iterator>
+struct ChunkTraits
+{
+	/// \brief Find out if the end of a chunk has been reached and more input is needed to continue
+	static inline bool needMore( const Iterator&)			{return false;}
+};
+
+template <>
+struct ChunkTraits<SrcIterator>
+{
+	static inline bool needMore( const SrcIterator& itr)		{return itr.needMore();}
+};
+
+/// \class ByteRunTraits
+/// \brief Describes if a character set encoding can be scanned byte by byte with ASCII characters represented as single bytes
+template <class CharSet>
+struct ByteRunTraits
+{
+	enum
+	{
+		Enabled=0,		///< true, if the character set can be scanned byte by byte
+		MultiByte=0,		///< true, if a non ASCII character can consist of more than one byte
+		Unicode=0		///< true, if blocks can be converted to UTF-16 or UCS-4 in one go
+	};
+	/// \brief Get the length of the longest prefix of a block that consists of valid characters only
+	/// \param [in] size size of the block in bytes
+	static inline std::size_t validLength( const char*, std::size_t size)	{return size;}
+	/// \brief Get the largest position not greater than a given one that is not in the middle of a character
+	/// \param [in] pos the position
+	static inline std::size_t charBoundary( const char*, std::size_t pos)	{return pos;}
+	/// \brief Convert a block to UTF-16 code units (see UTF8Block::convertToUTF16(const char*,std::size_t,unsigned short*,std::size_t&))
+	static inline bool convertToUTF16( const char*, std::size_t, unsigned short*, std::size_t& destsize)	{destsize=0; return false;}
+	/// \brief Convert a block to UCS-4 (see UTF8Block::convertToUCS4(const char*,std::size_t,UChar*,std::size_t&))
+	static inline bool convertToUCS4( const char*, std::size_t, UChar*, std::size_t& destsize)		{destsize=0; return false;}
+	/// \brief Convert a block to a single byte code page (see UTF8Block::convertToCodePage(const char*,std::size_t,const CodePage&,char*,std::size_t&))
+	template <class CodePage>
+	static inline std::size_t convertToCodePage( const char*, std::size_t, const CodePage&, char*, std::size_t& destsize)	{destsize=0; return 0;}
+};
+
+template <>
+struct ByteRunTraits<charset::UTF8>
+{
+	enum {Enabled=1,MultiByte=1,Unicode=1};
+	static inline std::size_t validLength( const char* src, std::size_t size)
+	{
+		return UTF8Block::validLength( src, size);
+	}
+	static inline std::size_t charBoundary( const char* src, std::size_t pos)
+	{
+		for (unsigned int ii=0; ii<3 && pos && ((unsigned char)src[ pos] & 0xC0) == 0x80; ++ii) --pos;
+		return pos;
+	}
+	static inline bool convertToUTF16( const char* src, std::size_t size, unsigned short* dest, std::size_t& destsize)
+	{
+		return UTF8Block::convertToUTF16( src, size, dest, destsize);
+	}
+	static inline bool convertToUCS4( const char* src, std::size_t size, UChar* dest, std::size_t& destsize)
+	{
+		return UTF8Block::convertToUCS4( src, size, dest, destsize);
+	}
+	template <class CodePage>
+	static inline std::size_t convertToCodePage( const char* src, std::size_t size, const CodePage& cp, char* dest, std::size_t& destsize)
+	{
+		return UTF8Block::convertToCodePage( src, size, cp, dest, destsize);
+	}
+};
+
+template <>
+struct ByteRunTraits<charset::IsoLatin>
+{
+	enum {Enabled=1,MultiByte=0,Unicode=0};
+	static inline std::size_t validLength( const char*, std::size_t size)	{return size;}
+	static inline std::size_t charBoundary( const char*, std::size_t pos)	{return pos;}
+	static inline bool convertToUTF16( const char*, std::size_t, unsigned short*, std::size_t& destsize)	{destsize=0; return false;}
+	static inline bool convertToUCS4( const char*, std::size_t, UChar*, std::size_t& destsize)		{destsize=0; return false;}
+	template <class CodePage>
+	static inline std::size_t convertToCodePage( const char*, std::size_t, const CodePage&, char*, std::size_t& destsize)	{destsize=0; return 0;}
+};
+
+/// \class UTF16OutputTraits
+/// \brief Describes if a character set encoding is UTF-16, so that UTF-16 code units converted in one go can be written without encoding them character by character
+template <class CharSet>
+struct UTF16OutputTraits
+{
+	enum
+	{
+		Enabled=0,		///< true, if the character set is UTF-16
+		BigEndian=0		///< true, if the code units are written big endian
+	};
+};
+
+template <int encoding>
+struct UTF16OutputTraits<charset::UTF16<encoding> >
+{
+	enum {Enabled=1,BigEndian=(encoding==charset::ByteOrder::BE)};
+};
+
+template <>
+struct UTF16OutputTraits<charset::UTF16LE>	:public UTF16OutputTraits<charset::UTF16<charset::ByteOrder::LE> > {};
+template <>
+struct UTF16OutputTraits<charset::UTF16BE>	:public UTF16OutputTraits<charset::UTF16<charset::ByteOrder::BE> > {};
+
+/// \class CodePageOutputTraits
+/// \brief Describes if a character set encoding is a single byte code page, so that blocks can be converted to it in one go (see ByteRunTraits::convertToCodePage)
+template <class CharSet>
+struct CodePageOutputTraits
+{
+	enum {Enabled=0};		///< true, if the character set is a single byte code page with invcode(UChar)
+	/// \brief Convert a block of the source character set encoding to the code page (see ByteRunTraits::convertToCodePage)
+	template <class SrcCharSet>
+	static inline std::size_t convert( const char*, std::size_t, const CharSet&, char*, std::size_t& destsize)	{destsize=0; return 0;}
+};
+
+template <>
+struct CodePageOutputTraits<charset::IsoLatin>
+{
+	enum {Enabled=1};
+	template <class SrcCharSet>
+	static inline std::size_t convert( const char* src, std::size_t size, const charset::IsoLatin& cp, char* dest, std::size_t& destsize)
+	{
+		return ByteRunTraits<SrcCharSet>::convertToCodePage( src, size, cp, dest, destsize);
+	}
+};
+
+/// \class InvalidCharTraits
+/// \brief Describes how the decoder of a character set encoding reports malformed input
+template <class CharSet>
+struct InvalidCharTraits
+{
+	/// \brief Find out if a character returned by the decoder stands for malformed input
+	static inline bool isInvalid( UChar)		{return false;}
+};
+
+template <>
+struct InvalidCharTraits<charset::UTF8>
+{
+	static inline bool isInvalid( UChar chr)	{return chr == (UChar)charset::UTF8::InvalidChar;}
+};
+
+/// \brief Append a block of bytes to an STL back insertion sequence
+/// \param [out] buf buffer to append to
+/// \param [in] ptr pointer to the bytes to append
+/// \param [in] size number of bytes to append
+template <class Buffer>
+inline void appendBytes( Buffer& buf, const char* ptr, std::size_t size)
+{
+	for (std::size_t ii=0; ii<size; ++ii) buf.push_back( ptr[ ii]);
+}
+
+inline void appendBytes( std::string& buf, const char* ptr, std::size_t size)
+{
+	buf.append( ptr, size);
+}
+
+inline void appendBytes( StaticBuffer& buf, const char* ptr, std::size_t size)
+{
+	buf.append( ptr, size);
+}
+
+inline void appendBytes( ArenaBuffer& buf, const char* ptr, std::size_t size)
+{
+	buf.append( ptr, size);
+}
+
+/// \brief Free the contents of an output buffer, also the ones kept by buffers that keep previous contents when cleared
+/// \param [in,out] buf buffer to reset
+template <class Buffer>
+inline void resetBuffer( Buffer& buf)
+{
+	buf.clear();
+}
+
+inline void resetBuffer( ArenaBuffer& buf)
+{
+	buf.reset();
+}
+
 
 /// \class TextScanner
 /// \brief Reader for scanning the input character by character
@@ -167,6 +432,13 @@ public:
 		return val;
 	}
 
+	/// \brief Find out if the current character is malformed in the character set encoding of the source
+	/// \return true, if yes
+	inline bool invalid()
+	{
+		return InvalidCharTraits<CharSet>::isInvalid( chr());
+	}
+
 	/// \brief Fill the internal buffer with as many current character bytes needed for reading the ASCII representation
 	inline void getcur()
 	{
@@ -213,6 +485,290 @@ public:
 		}
 	}
 
+	/// \class RunDefinition
+	/// \brief Definition of the characters copied in one go by TextScanner::copyrun(const RunDefinition&,CharSet&,Buffer&)
+	class RunDefinition
+	{
+	public:
+		/// \brief Constructor
+		/// \param [in] isTok map of control characters belonging to a run
+		template <class IsControlCharMap>
+		explicit RunDefinition( const IsControlCharMap& isTok)
+			:m_nonascii(isTok[ Undef])
+		{
+			static ControlCharMap controlCharMap;
+			for (unsigned int ii=0; ii<128; ++ii)
+			{
+				if (!isTok[ controlCharMap[ (unsigned char)ii]]) m_delim( (unsigned char)ii);
+			}
+			m_delim( 0);
+			if (!m_nonascii) m_delim.highbit();
+		}
+
+		/// \brief Declare an additional ASCII character to end a run
+		/// \param [in] ch the character
+		/// \return *this
+		RunDefinition& exclude( unsigned char ch)
+		{
+			m_delim( ch);
+			return *this;
+		}
+
+		/// \brief Get the set of bytes ending a run
+		const ByteSet& delim() const	{return m_delim;}
+		/// \brief Find out if non ASCII characters belong to a run
+		bool nonascii() const		{return m_nonascii;}
+
+	private:
+		ByteSet m_delim;		///< set of bytes ending a run
+		bool m_nonascii;		///< true, if non ASCII characters belong to a run
+	};
+
+private:
+	/// \brief Get the length of the block starting at the current source position up to the first byte ending a run
+	/// \param [in] def definition of the characters belonging to the run
+	/// \return the length of the block in bytes (not validated)
+	inline std::size_t delimlength( const RunDefinition& def) const
+	{
+		const char* runstart = WindowTraits<Iterator>::begin( input);
+		const char* runend = WindowTraits<Iterator>::end( input);
+		if (runend && runstart >= runend) return 0;
+		return def.delim().find( runstart, runend) - runstart;
+	}
+
+	/// \brief Get the length of a run of characters starting at the current source position
+	/// \param [in] def definition of the characters belonging to the run
+	/// \return the length of the run in bytes
+	inline std::size_t runlength( const RunDefinition& def) const
+	{
+		// ... the run ends before the first malformed character, that is left to the character by character processing
+		return ByteRunTraits<CharSet>::validLength( WindowTraits<Iterator>::begin( input), delimlength( def));
+	}
+
+public:
+	/// \brief Copy a run of characters directly from the source to an output buffer without decoding and encoding them
+	/// \remark Does only copy something for source iterators on contiguous memory (see WindowTraits) and character set encodings that can be scanned byte by byte (see ByteRunTraits) if the scanner is positioned at the start of a character. The character following the run is left to the caller. Runs between encodings of the same class but not equal (IsoLatin code pages) are transcoded (see transcoderun(const RunDefinition&,const OutputCharSet&,Buffer&)).
+	/// \param [in] def definition of the characters belonging to the run
+	/// \param [in] output_ output character set encoding
+	/// \param [out] buf_ buffer to append the run to
+	/// \return the number of bytes copied
+	template <class Buffer>
+	inline std::size_t copyrun( const RunDefinition& def, CharSet& output_, Buffer& buf_)
+	{
+		if (!WindowTraits<Iterator>::Enabled || !ByteRunTraits<CharSet>::Enabled || state != 0) return 0;
+		if (!CharSet::is_equal( charset, output_)) return transcoderun( def, output_, buf_);
+
+		std::size_t rt = runlength( def);
+		if (rt)
+		{
+			appendBytes( buf_, WindowTraits<Iterator>::begin( input), rt);
+			WindowTraits<Iterator>::advance( input, rt);
+		}
+		return rt;
+	}
+
+private:
+	/// \class BlockBuffer
+	/// \brief Block of output bytes with a back insertion interface, written to the output buffer in one go when full
+	struct BlockBuffer
+	{
+		enum
+		{
+			Size=256,		///< number of bytes that triggers a flush of the block
+			Reserve=64		///< space reserved for the maximum size of one character printed (including the character reference for characters not representable in the output encoding)
+		};
+		char ar[ Size + Reserve];	///< block content
+		std::size_t size;		///< number of bytes in the block
+
+		BlockBuffer()			:size(0){}
+		void push_back( char ch)	{ar[ size++] = ch;}
+	};
+
+public:
+	/// \brief Decode a run of characters from the source and encode it in another character set encoding in one go
+	/// \remark Does only transcode something for source iterators on contiguous memory (see WindowTraits) with the end of the window known and if the scanner is positioned at the start of a character. Stops a few bytes before the end of the window, so that characters are never decoded beyond it. Runs of encodings that can be converted to UTF-16 or UCS-4 in one go (see ByteRunTraits) are converted block by block up to the first malformed character instead. The characters following the run are left to the caller.
+	/// \param [in] def definition of the characters belonging to the run
+	/// \param [in] output_ output character set encoding
+	/// \param [out] buf_ buffer to append the run to
+	/// \return the number of source bytes consumed
+	template <class OutputCharSet, class Buffer>
+	inline std::size_t transcoderun( const RunDefinition& def, const OutputCharSet& output_, Buffer& buf_)
+	{
+		enum {MaxCharSize=sizeof(buf)};
+		if (!WindowTraits<Iterator>::Enabled || state != 0) return 0;
+		if (ByteRunTraits<CharSet>::Unicode) return convertrun( def, output_, buf_);
+		const char* runstart = WindowTraits<Iterator>::begin( input);
+		const char* runend = WindowTraits<Iterator>::end( input);
+		if (!runend || runend - runstart < (std::ptrdiff_t)MaxCharSize) return 0;
+
+		const char* runlast = runend - MaxCharSize;
+		const char* pp = runstart;
+		BlockBuffer block;
+		char chrbuf[ MaxCharSize];
+		while (pp <= runlast)
+		{
+			const char* itr = pp;
+			unsigned int chrpos = 0;
+			UChar chr = charset.value( chrbuf, chrpos, itr);
+			if (chr < 0x80 ? def.delim().contains( (unsigned char)chr) : !def.nonascii()) break;
+			output_.print( chr, block);
+			pp = itr;
+			if (block.size >= (std::size_t)BlockBuffer::Size)
+			{
+				appendBytes( buf_, block.ar, block.size);
+				block.size = 0;
+			}
+		}
+		if (block.size) appendBytes( buf_, block.ar, block.size);
+		std::size_t rt = pp - runstart;
+		if (rt) WindowTraits<Iterator>::advance( input, rt);
+		return rt;
+	}
+
+private:
+	enum {ConvertBlockSize=256};	///< number of source bytes converted in one go by convertrun(const RunDefinition&,const OutputCharSet&,Buffer&)
+
+	/// \brief Transcode a run of characters of an encoding that can be converted to UTF-16 or UCS-4 in one go (see ByteRunTraits)
+	/// \remark Converts the run block by block, the output is written directly for UTF-16 and single byte code pages and character by character for other encodings. Stops before the first malformed character and for single byte code pages also before the first character not representable.
+	/// \param [in] def definition of the characters belonging to the run
+	/// \param [in] output_ output character set encoding
+	/// \param [out] buf_ buffer to append the run to
+	/// \return the number of source bytes consumed
+	template <class OutputCharSet, class Buffer>
+	inline std::size_t convertrun( const RunDefinition& def, const OutputCharSet& output_, Buffer& buf_)
+	{
+		const char* runstart = WindowTraits<Iterator>::begin( input);
+		std::size_t runsize = delimlength( def);
+		std::size_t rt = 0;
+		while (rt < runsize)
+		{
+			const char* blk = runstart + rt;
+			std::size_t blksize = runsize - rt;
+			if (blksize > (std::size_t)ConvertBlockSize)
+			{
+				blksize = ByteRunTraits<CharSet>::charBoundary( blk, ConvertBlockSize);
+			}
+			std::size_t destsize;
+			bool valid;
+			if (UTF16OutputTraits<OutputCharSet>::Enabled)
+			{
+				unsigned short dest[ ConvertBlockSize];
+				char out[ ConvertBlockSize * 2];
+				valid = ByteRunTraits<CharSet>::convertToUTF16( blk, blksize, dest, destsize);
+				for (std::size_t ii=0; ii<destsize; ++ii)
+				{
+					unsigned char hi = (unsigned char)(dest[ ii] >> 8);
+					unsigned char lo = (unsigned char)(dest[ ii] & 0xFF);
+					out[ ii*2] = (char)(UTF16OutputTraits<OutputCharSet>::BigEndian ? hi : lo);
+					out[ ii*2+1] = (char)(UTF16OutputTraits<OutputCharSet>::BigEndian ? lo : hi);
+				}
+				appendBytes( buf_, out, destsize * 2);
+			}
+			else if (CodePageOutputTraits<OutputCharSet>::Enabled)
+			{
+				char out[ ConvertBlockSize];
+				std::size_t converted = CodePageOutputTraits<OutputCharSet>::template convert<CharSet>( blk, blksize, output_, out, destsize);
+				appendBytes( buf_, out, destsize);
+				if (converted < blksize)
+				{
+					// ... the malformed character or the character printed as character reference is left to the caller
+					rt += converted;
+					break;
+				}
+				valid = true;
+			}
+			else
+			{
+				UChar dest[ ConvertBlockSize];
+				BlockBuffer block;
+				valid = ByteRunTraits<CharSet>::convertToUCS4( blk, blksize, dest, destsize);
+				for (std::size_t ii=0; ii<destsize; ++ii)
+				{
+					output_.print( dest[ ii], block);
+					if (block.size >= (std::size_t)BlockBuffer::Size)
+					{
+						appendBytes( buf_, block.ar, block.size);
+						block.size = 0;
+					}
+				}
+				if (block.size) appendBytes( buf_, block.ar, block.size);
+			}
+			if (!valid)
+			{
+				// ... the characters of the valid prefix have been written, the malformed character is left to the caller
+				rt += ByteRunTraits<CharSet>::validLength( blk, blksize);
+				break;
+			}
+			rt += blksize;
+		}
+		if (rt) WindowTraits<Iterator>::advance( input, rt);
+		return rt;
+	}
+
+public:
+	/// \brief Skip a run of characters like copyrun(const RunDefinition&,CharSet&,Buffer&) but without copying it
+	/// \param [in] def definition of the characters belonging to the run
+	/// \param [out] size the number of bytes skipped
+	/// \return pointer to the skipped run in the source window or NULL if nothing was skipped
+	inline const char* skiprun( const RunDefinition& def, std::size_t& size)
+	{
+		size = 0;
+		if (!WindowTraits<Iterator>::Enabled || !ByteRunTraits<CharSet>::Enabled || state != 0) return 0;
+
+		const char* rt = WindowTraits<Iterator>::begin( input);
+		size = runlength( def);
+		if (!size) return 0;
+		WindowTraits<Iterator>::advance( input, size);
+		return rt;
+	}
+
+	/// \brief Skip all bytes of the source up to the first byte belonging to a set in one go
+	/// \remark Does only skip something for source iterators on contiguous memory (see WindowTraits) and character set encodings that can be scanned byte by byte (see ByteRunTraits) if the scanner is positioned at the start of a character. Only sets of ASCII bytes are allowed, so that no multibyte character is split. For null terminated sources the set has to contain '\0'.
+	/// \param [in] stop set of bytes to stop at
+	/// \return the number of bytes skipped
+	inline std::size_t skipbytes( const ByteSet& stop)
+	{
+		if (!WindowTraits<Iterator>::Enabled || !ByteRunTraits<CharSet>::Enabled || state != 0) return 0;
+		const char* start = WindowTraits<Iterator>::begin( input);
+		std::size_t rt = stop.find( start, WindowTraits<Iterator>::end( input)) - start;
+		if (rt) WindowTraits<Iterator>::advance( input, rt);
+		return rt;
+	}
+
+	/// \brief Find out if the scanner can hand out pointers into the source as views on the input (zero-copy)
+	/// \param [in] output_ output character set encoding
+	/// \return true, if yes
+	inline bool hasStableWindow( const CharSet& output_) const
+	{
+		return WindowTraits<Iterator>::Enabled && ByteRunTraits<CharSet>::Enabled && WindowTraits<Iterator>::stable( input) && CharSet::is_equal( charset, output_);
+	}
+
+	/// \brief Get the pointer to the current character in the source window
+	/// \remark Only valid if hasStableWindow(const CharSet&) returns true
+	/// \param [out] size number of bytes of the current character
+	/// \return pointer to the first byte of the current character
+	inline const char* charptr( std::size_t& size)
+	{
+		charset.fetchbytes( buf, state, input);
+		size = state;
+		return WindowTraits<Iterator>::begin( input) - state;
+	}
+
+	/// \brief Get the pointer to the current source position in the source window
+	/// \remark Only valid if hasStableWindow(const CharSet&) returns true
+	/// \return pointer to the first byte of the current character
+	inline const char* windowptr() const
+	{
+		return WindowTraits<Iterator>::begin( input) - state;
+	}
+
+	/// \brief Find out if the end of a chunk that is not the end of data has been reached before the current character (see ChunkTraits)
+	/// \return true, if more input is needed to read the current character
+	inline bool needMore() const
+	{
+		return state == 0 && ChunkTraits<Iterator>::needMore( input);
+	}
+
 	/// \brief Get the control character representation of the current character
 	/// \return the control character
 	inline ControlCharacter control()
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \file textwolf/utf8block.hpp
+/// \brief Strict validation of UTF-8 and conversion of UTF-8 to UTF-16, UCS-4 and single byte code pages on contiguous blocks of memory
+/// \remark Runs of ASCII characters are processed 16 or 32 bytes at once with SSE2 or AVX2 if available at compile time (define TEXTWOLF_NO_SIMD to disable), multibyte characters with a scalar state machine
+
+#ifndef __TEXTWOLF_UTF8_BLOCK_HPP__
+#define __TEXTWOLF_UTF8_BLOCK_HPP__
+#include "textwolf/char.hpp"
+#include "textwolf/bytescan.hpp"
+#include <cstddef>
+
+namespace textwolf {
+
+/// \class UTF8Block
+/// \brief Strict UTF-8 validation (RFC 3629) and block conversion of UTF-8 to UTF-16, UCS-4 and single byte code pages
+/// \remark Rejected are: continuation bytes without lead byte, the 5 and 6 byte forms and the bytes 0xFE,0xFF, overlong encodings, encoded surrogates [0xD800..0xDFFF], characters above 0x10FFFF and incomplete characters
+struct UTF8Block
+{
+	/// \brief Get the length of the strictly valid UTF-8 character at the start of a block
+	/// \param [in] src pointer to the character
+	/// \param [in] avail number of bytes available (bytes after a null byte are not read, so a null terminated block may pass 4)
+	/// \return the length of the character in bytes or 0 if it is not valid or incomplete
+	static inline unsigned int sequenceLength( const char* src, std::size_t avail)
+	{
+		const unsigned char* cc = (const unsigned char*)src;
+		if (!avail) return 0;
+		unsigned char c0 = cc[0];
+		if (c0 < 0x80) return 1;
+		if (c0 < 0xC2) return 0;
+		if (c0 < 0xE0)
+		{
+			return (avail >= 2 && isCont( cc[1])) ? 2 : 0;
+		}
+		if (c0 < 0xF0)
+		{
+			if (avail < 3) return 0;
+			unsigned char c1 = cc[1];
+			if (c0 == 0xE0 ? (c1 < 0xA0 || c1 > 0xBF) : c0 == 0xED ? (c1 < 0x80 || c1 > 0x9F) : !isCont( c1)) return 0;
+			return isCont( cc[2]) ? 3 : 0;
+		}
+		if (c0 < 0xF5)
+		{
+			if (avail < 4) return 0;
+			unsigned char c1 = cc[1];
+			if (c0 == 0xF0 ? (c1 < 0x90 || c1 > 0xBF) : c0 == 0xF4 ? (c1 < 0x80 || c1 > 0x8F) : !isCont( c1)) return 0;
+			return (isCont( cc[2]) && isCont( cc[3])) ? 4 : 0;
+		}
+		return 0;
+	}
+
+	/// \brief Get the length of the run of ASCII characters at the start of a block
+	/// \param [in] src pointer to the block
+	/// \param [in] srcsize size of the block in bytes
+	/// \return the number of ASCII bytes
+	static inline std::size_t asciiLength( const char* src, std::size_t srcsize)
+	{
+		const char* pp = src;
+		const char* ee = src + srcsize;
+#if defined(TEXTWOLF_SIMD_AVX2)
+		for (; ee - pp >= 32 && _mm256_movemask_epi8( _mm256_loadu_si256( (const __m256i*)pp)) == 0; pp += 32){}
+#endif
+#if defined(TEXTWOLF_SIMD_SSE2)
+		for (; ee - pp >= 16 && _mm_movemask_epi8( _mm_loadu_si128( (const __m128i*)pp)) == 0; pp += 16){}
+#endif
+		for (; pp != ee && (unsigned char)*pp < 0x80; ++pp){}
+		return pp - src;
+	}
+
+	/// \brief Get the length of the run of strictly valid non ASCII UTF-8 characters at the start of a block
+	/// \param [in] src pointer to the block
+	/// \param [in] end end of the block or NULL if the block is null terminated
+	/// \return the number of bytes of the run
+	static inline std::size_t multiByteLength( const char* src, const char* end)
+	{
+		const char* pp = src;
+		while ((end ? (pp < end) : true) && (unsigned char)*pp >= 0x80)
+		{
+			unsigned int len = sequenceLength( pp, end ? (std::size_t)(end - pp) : 4);
+			if (!len) break;
+			pp += len;
+		}
+		return pp - src;
+	}
+
+	/// \brief Get the length of the longest strictly valid UTF-8 prefix of a block
+	/// \param [in] src pointer to the block
+	/// \param [in] srcsize size of the block in bytes
+	/// \return the size of the valid prefix in bytes, equal to srcsize if the whole block is valid UTF-8
+	static inline std::size_t validLength( const char* src, std::size_t srcsize)
+	{
+		std::size_t pos = 0;
+		for (;;)
+		{
+			pos += asciiLength( src + pos, srcsize - pos);
+			if (pos == srcsize) return pos;
+			std::size_t mb = multiByteLength( src + pos, src + srcsize);
+			if (!mb) return pos;
+			pos += mb;
+		}
+	}
+
+	/// \brief Check if a block is strictly valid UTF-8
+	/// \param [in] src pointer to the block
+	/// \param [in] srcsize size of the block in bytes
+	/// \return true if yes
+	static inline bool isValid( const char* src, std::size_t srcsize)
+	{
+		return validLength( src, srcsize) == srcsize;
+	}
+
+	/// \brief Convert a block of UTF-8 to UTF-16 code units in the byte order of the machine
+	/// \param [in] src pointer to the block
+	/// \param [in] srcsize size of the block in bytes
+	/// \param [out] dest where to write the code units to, must have space for srcsize code units
+	/// \param [out] destsize number of code units written
+	/// \return true on success, false if the block is not strictly valid UTF-8 (then destsize is the number of code units of the valid prefix)
+	static inline bool convertToUTF16( const char* src, std::size_t srcsize, unsigned short* dest, std::size_t& destsize)
+	{
+		const char* pp = src;
+		const char* ee = src + srcsize;
+		unsigned short* dd = dest;
+		while (pp != ee)
+		{
+#if defined(TEXTWOLF_SIMD_SSE2)
+			const __m128i zero = _mm_setzero_si128();
+			for (; ee - pp >= 16; pp += 16, dd += 16)
+			{
+				__m128i vv = _mm_loadu_si128( (const __m128i*)pp);
+				if (_mm_movemask_epi8( vv) != 0) break;
+				_mm_storeu_si128( (__m128i*)dd, _mm_unpacklo_epi8( vv, zero));
+				_mm_storeu_si128( (__m128i*)(dd + 8), _mm_unpackhi_epi8( vv, zero));
+			}
+#endif
+			for (; pp != ee && (unsigned char)*pp < 0x80; ++pp,++dd) *dd = (unsigned short)(unsigned char)*pp;
+			while (pp != ee && (unsigned char)*pp >= 0x80)
+			{
+				unsigned int len = sequenceLength( pp, ee - pp);
+				if (!len)
+				{
+					destsize = dd - dest;
+					return false;
+				}
+				UChar chr = decode( pp, len);
+				if (chr >= 0x10000)
+				{
+					chr -= 0x10000;
+					*dd++ = (unsigned short)(0xD800 + (chr >> 10));
+					*dd++ = (unsigned short)(0xDC00 + (chr & 0x3FF));
+				}
+				else
+				{
+					*dd++ = (unsigned short)chr;
+				}
+				pp += len;
+			}
+		}
+		destsize = dd - dest;
+		return true;
+	}
+
+	/// \brief Convert a block of UTF-8 to UCS-4 (unicode characters)
+	/// \param [in] src pointer to the block
+	/// \param [in] srcsize size of the block in bytes
+	/// \param [out] dest where to write the characters to, must have space for srcsize characters
+	/// \param [out] destsize number of characters written
+	/// \return true on success, false if the block is not strictly valid UTF-8 (then destsize is the number of characters of the valid prefix)
+	static inline bool convertToUCS4( const char* src, std::size_t srcsize, UChar* dest, std::size_t& destsize)
+	{
+		const char* pp = src;
+		const char* ee = src + srcsize;
+		UChar* dd = dest;
+		while (pp != ee)
+		{
+#if defined(TEXTWOLF_SIMD_SSE2)
+			const __m128i zero = _mm_setzero_si128();
+			for (; ee - pp >= 16; pp += 16, dd += 16)
+			{
+				__m128i vv = _mm_loadu_si128( (const __m128i*)pp);
+				if (_mm_movemask_epi8( vv) != 0) break;
+				__m128i lo = _mm_unpacklo_epi8( vv, zero);
+				__m128i hi = _mm_unpackhi_epi8( vv, zero);
+				_mm_storeu_si128( (__m128i*)dd, _mm_unpacklo_epi16( lo, zero));
+				_mm_storeu_si128( (__m128i*)(dd + 4), _mm_unpackhi_epi16( lo, zero));
+				_mm_storeu_si128( (__m128i*)(dd + 8), _mm_unpacklo_epi16( hi, zero));
+				_mm_storeu_si128( (__m128i*)(dd + 12), _mm_unpackhi_epi16( hi, zero));
+			}
+#endif
+			for (; pp != ee && (unsigned char)*pp < 0x80; ++pp,++dd) *dd = (UChar)(unsigned char)*pp;
+			while (pp != ee && (unsigned char)*pp >= 0x80)
+			{
+				unsigned int len = sequenceLength( pp, ee - pp);
+				if (!len)
+				{
+					destsize = dd - dest;
+					return false;
+				}
+				*dd++ = decode( pp, len);
+				pp += len;
+			}
+		}
+		destsize = dd - dest;
+		return true;
+	}
+
+	/// \brief Convert a block of UTF-8 to a single byte code page (e.g. ISO-8859-x)
+	/// \tparam CodePage code page with invcode(UChar) returning the byte of a character or 0 if it is not representable (e.g. charset::IsoLatin)
+	/// \param [in] src pointer to the block
+	/// \param [in] srcsize size of the block in bytes
+	/// \param [in] cp the code page
+	/// \param [out] dest where to write the bytes to, must have space for srcsize bytes
+	/// \param [out] destsize number of bytes written
+	/// \return the number of source bytes converted, less than srcsize if the conversion stopped before a malformed character or a character not representable in the code page
+	template <class CodePage>
+	static inline std::size_t convertToCodePage( const char* src, std::size_t srcsize, const CodePage& cp, char* dest, std::size_t& destsize)
+	{
+		const char* pp = src;
+		const char* ee = src + srcsize;
+		char* dd = dest;
+		while (pp != ee)
+		{
+#if defined(TEXTWOLF_SIMD_SSE2)
+			for (; ee - pp >= 16; pp += 16, dd += 16)
+			{
+				__m128i vv = _mm_loadu_si128( (const __m128i*)pp);
+				if (_mm_movemask_epi8( vv) != 0) break;
+				_mm_storeu_si128( (__m128i*)dd, vv);
+			}
+#endif
+			for (; pp != ee && (unsigned char)*pp < 0x80; ++pp,++dd) *dd = *pp;
+			while (pp != ee && (unsigned char)*pp >= 0x80)
+			{
+				unsigned int len = sequenceLength( pp, ee - pp);
+				char ch = len ? cp.invcode( decode( pp, len)) : 0;
+				if (!ch)
+				{
+					destsize = dd - dest;
+					return pp - src;
+				}
+				*dd++ = ch;
+				pp += len;
+			}
+		}
+		destsize = dd - dest;
+		return pp - src;
+	}
+
+	/// \brief Decode a valid UTF-8 character
+	/// \param [in] src pointer to the character
+	/// \param [in] len length of the character in bytes (see sequenceLength(const char*,std::size_t))
+	/// \return the unicode character
+	static inline UChar decode( const char* src, unsigned int len)
+	{
+		const unsigned char* cc = (const unsigned char*)src;
+		switch (len)
+		{
+			case 1: return cc[0];
+			case 2: return ((UChar)(cc[0] & 0x1F) << 6) | (cc[1] & 0x3F);
+			case 3: return ((UChar)(cc[0] & 0x0F) << 12) | ((UChar)(cc[1] & 0x3F) << 6) | (cc[2] & 0x3F);
+			default: return ((UChar)(cc[0] & 0x07) << 18) | ((UChar)(cc[1] & 0x3F) << 12) | ((UChar)(cc[2] & 0x3F) << 6) | (cc[3] & 0x3F);
+		}
+	}
+
+private:
+	/// \brief Check if a byte is a UTF-8 continuation byte
+	static inline bool isCont( unsigned char ch)
+	{
+		return (ch & 0xC0) == 0x80;
+	}
+};
+
+}//namespace
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \file textwolf/xmlextractor.hpp
+/// \brief Driver scanning an XML document and selecting path expressions from it in one loop
+
+#ifndef __TEXTWOLF_XML_EXTRACTOR_HPP__
+#define __TEXTWOLF_XML_EXTRACTOR_HPP__
+#include "textwolf/xmlscanner.hpp"
+#include "textwolf/xmlpathselect.hpp"
+#include <cstddef>
+
+namespace textwolf {
+
+/// \class XMLExtractor
+/// \brief Driver feeding the elements of an XMLScanner to an XMLPathSelect and passing the elements selected to a handler
+/// \tparam Scanner XMLScanner type
+/// \tparam Selector XMLPathSelect type
+/// \tparam Handler type of the handler called for every element selected with handler.selected( int typeidx, XMLScannerBase::ElementType type, const char* content, std::size_t size)
+/// \remark This is the recommended way to select elements from XML with high throughput. The handler is a template parameter, so its calls are resolved at compile time. Elements of types no active expression can match are scanned without building their content (see XMLPathSelect::outputMask() and XMLScanner::nextItem(unsigned short)), subtrees where nothing can be selected are skipped (see XMLPathSelect::subtreeIsIrrelevant()) and the scanning is stopped as soon as nothing can be selected anymore (see XMLPathSelect::selectionIsExhausted()). The element keys are resolved by the scanner with the symbol table of the automaton, so the output character set encoding of the scanner has to be the one of the automaton.
+template <class Scanner, class Selector, class Handler>
+class XMLExtractor
+{
+public:
+	/// \brief Constructor
+	/// \param [in] scanner_ scanner of the document (not owned)
+	/// \param [in] selector_ selector with the automaton of the expressions to select (not owned)
+	/// \param [in] handler_ handler called for the elements selected (not owned)
+	XMLExtractor( Scanner& scanner_, Selector& selector_, Handler& handler_)
+		:m_scanner(&scanner_),m_selector(&selector_),m_handler(&handler_),m_skip(false)
+	{
+		m_scanner->setSymbolTable( &selector_.automaton()->symbols());
+	}
+
+	/// \brief Scan and select until the end of the document, an error or the end of a chunk fed to the scanner
+	/// \return Exit at the end of the document or if nothing can be selected anymore, ErrorOccurred on a scanner error (see XMLScanner::getError(const char**)) or None if the end of a chunk was reached and the scanner needs more input (see XMLScanner::feed(const char*,std::size_t,bool)), then run() can be called again after feeding it
+	XMLScannerBase::ElementType run()
+	{
+		for (;;)
+		{
+			XMLScannerBase::ElementType type = m_skip ? m_scanner->skipSubtree() : m_scanner->nextItem( m_selector->outputMask());
+			m_skip = false;
+			switch (type)
+			{
+				case XMLScannerBase::None:
+				case XMLScannerBase::ErrorOccurred:
+				case XMLScannerBase::Exit:
+					return type;
+				default:
+					break;
+			}
+			HandlerCall call( *m_handler, type, m_scanner->getItemPtr(), m_scanner->getItemSize());
+			m_selector->select( type, call.content, call.size, m_scanner->getItemSymbol(), call);
+
+			if (type == XMLScannerBase::OpenTag && m_selector->subtreeIsIrrelevant())
+			{
+				m_skip = true;
+			}
+			else if (m_selector->selectionIsExhausted())
+			{
+				return XMLScannerBase::Exit;
+			}
+		}
+	}
+
+private:
+	/// \class HandlerCall
+	/// \brief Function object passed to XMLPathSelect::select(XMLScannerBase::ElementType,const char*,std::size_t,int,Handler&) calling the handler with the current element
+	struct HandlerCall
+	{
+		Handler* handler;
+		XMLScannerBase::ElementType type;
+		const char* content;
+		std::size_t size;
+
+		HandlerCall( Handler& handler_, XMLScannerBase::ElementType type_, const char* content_, std::size_t size_)
+			:handler(&handler_),type(type_),content(content_),size(size_){}
+
+		void operator()( int typeidx)
+		{
+			handler->selected( typeidx, type, content, size);
+		}
+	};
+
+private:
+	Scanner* m_scanner;		///< scanner of the document
+	Selector* m_selector;		///< selector of the elements
+	Handler* m_handler;		///< handler of the elements selected
+	bool m_skip;			///< true, if the subtree of the last open tag is skipped with the next scanner call
+};
+
+}//namespace
+#endif
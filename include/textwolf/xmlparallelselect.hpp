@@ -0,0 +1,500 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \file textwolf/xmlparallelselect.hpp
+/// \brief XML path selection on a memory resident document split into chunks processed in parallel
+/// \remark Uses std::thread if compiled with C++11 or newer (define TEXTWOLF_NO_THREADS to disable), processes the chunks one after the other otherwise
+
+#ifndef __TEXTWOLF_XML_PARALLEL_SELECT_HPP__
+#define __TEXTWOLF_XML_PARALLEL_SELECT_HPP__
+#include "textwolf/exception.hpp"
+#include "textwolf/xmlscanner.hpp"
+#include "textwolf/xmlpathselect.hpp"
+#include "textwolf/xmlpathautomaton.hpp"
+#include "textwolf/sourceiterator.hpp"
+#include "textwolf/bytescan.hpp"
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstddef>
+
+#if !defined(TEXTWOLF_NO_THREADS) && (__cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1700))
+#include <thread>
+#define TEXTWOLF_HAS_THREADS
+#endif
+
+namespace textwolf {
+
+/// \class XMLSplitScanner
+/// \brief Structural scan of an XML document for points where it can be split into chunks scanned independently
+/// \remark Only jumps from markup to markup (comments, CDATA sections, processing instructions and quoted attribute values are skipped as a whole), so it is much faster than the XML scanner. Works for character set encodings representing ASCII characters as single bytes (UTF-8, IsoLatin).
+class XMLSplitScanner
+{
+public:
+	/// \class Range
+	/// \brief Range in the source document
+	struct Range
+	{
+		std::size_t start;	///< start offset in the source
+		std::size_t end;	///< end offset in the source
+
+		Range( std::size_t start_=0, std::size_t end_=0)
+			:start(start_),end(end_){}
+	};
+
+	/// \brief Constructor
+	/// \param [in] src pointer to the source document
+	/// \param [in] srcsize size of the source document in bytes
+	/// \param [in] splitDepth depth of the elements in front of which the document can be split (0 for the root element, 1 for its children, etc.)
+	XMLSplitScanner( const char* src, std::size_t srcsize, unsigned int splitDepth)
+		:m_src(src),m_size(srcsize),m_pos(0),m_splitDepth(splitDepth)
+	{
+		m_markup('<');
+	}
+
+	/// \brief Get the next point where the document can be split
+	/// \param [in] minpos minimum offset of the split point
+	/// \param [out] pos offset of the split point (start of an element at the split depth)
+	/// \param [out] ancestors ranges of the open tags of the ancestors of the element starting at 'pos'
+	/// \return true, if a split point was found, false if the end of the document was reached
+	bool next( std::size_t minpos, std::size_t& pos, std::vector<Range>& ancestors)
+	{
+		const char* ee = m_src + m_size;
+		for (;;)
+		{
+			const char* pp = m_markup.find( m_src + m_pos, ee);
+			if (ee - pp < 2) break;
+			m_pos = pp - m_src;
+			switch (pp[1])
+			{
+				case '?':
+					skipTo( m_pos + 2, "?>");
+					break;
+				case '!':
+					if (startsWith( pp, "<!--"))
+					{
+						skipTo( m_pos + 4, "-->");
+					}
+					else if (startsWith( pp, "<![CDATA["))
+					{
+						skipTo( m_pos + 9, "]]>");
+					}
+					else
+					{
+						skipDeclaration();
+					}
+					break;
+				case '/':
+					m_pos = skipTag( m_pos + 2);
+					if (!m_stack.empty()) m_stack.pop_back();
+					break;
+				default:
+				{
+					std::size_t tagstart = m_pos;
+					m_pos = skipTag( m_pos + 1);
+					bool isSplit = (m_stack.size() == m_splitDepth && tagstart >= minpos);
+					if (isSplit)
+					{
+						pos = tagstart;
+						ancestors = m_stack;
+					}
+					if (m_pos <= m_size && m_src[ m_pos - 1] == '>' && m_src[ m_pos - 2] != '/')
+					{
+						m_stack.push_back( Range( tagstart, m_pos));
+					}
+					if (isSplit) return true;
+				}
+			}
+		}
+		m_pos = m_size;
+		return false;
+	}
+
+private:
+	static bool startsWith( const char* pp, const char* prefix)
+	{
+		return 0==std::memcmp( pp, prefix, std::strlen( prefix));
+	}
+
+	/// \brief Skip to the position after the end marker 'str'
+	void skipTo( std::size_t pos, const char* str)
+	{
+		std::size_t len = std::strlen( str);
+		for (;;)
+		{
+			const void* pp = (pos < m_size) ? std::memchr( m_src + pos, str[0], m_size - pos) : 0;
+			if (!pp)
+			{
+				m_pos = m_size;
+				return;
+			}
+			pos = (const char*)pp - m_src;
+			if (m_size - pos >= len && 0==std::memcmp( m_src + pos, str, len))
+			{
+				m_pos = pos + len;
+				return;
+			}
+			++pos;
+		}
+	}
+
+	/// \brief Skip the rest of a tag starting at 'pos', respecting quoted attribute values
+	/// \return the position after the closing '>'
+	std::size_t skipTag( std::size_t pos) const
+	{
+		static const ByteSet tagEnd = ByteSet()('>')('\'')('"');
+		const char* ee = m_src + m_size;
+		const char* pp = m_src + pos;
+		for (;;)
+		{
+			pp = tagEnd.find( pp, ee);
+			if (pp == ee) return m_size;
+			if (*pp == '>') return pp - m_src + 1;
+			const void* qq = std::memchr( pp + 1, *pp, ee - pp - 1);
+			if (!qq) return m_size;
+			pp = (const char*)qq + 1;
+		}
+	}
+
+	/// \brief Skip a document type declaration with an optional internal subset in square brackets
+	void skipDeclaration()
+	{
+		static const ByteSet declEnd = ByteSet()('>')('\'')('"')('[')(']');
+		const char* ee = m_src + m_size;
+		const char* pp = m_src + m_pos + 2;
+		int brackets = 0;
+		for (;;)
+		{
+			pp = declEnd.find( pp, ee);
+			if (pp == ee) break;
+			switch (*pp)
+			{
+				case '[': ++brackets; ++pp; break;
+				case ']': --brackets; ++pp; break;
+				case '>':
+					++pp;
+					if (brackets <= 0)
+					{
+						m_pos = pp - m_src;
+						return;
+					}
+					break;
+				default:
+				{
+					const void* qq = std::memchr( pp + 1, *pp, ee - pp - 1);
+					pp = qq ? ((const char*)qq + 1) : ee;
+				}
+			}
+		}
+		m_pos = m_size;
+	}
+
+private:
+	const char* m_src;			///< source document
+	std::size_t m_size;			///< size of the source document in bytes
+	std::size_t m_pos;			///< current scan position
+	unsigned int m_splitDepth;		///< depth of the elements in front of which the document can be split
+	ByteSet m_markup;			///< set of bytes starting markup
+	std::vector<Range> m_stack;		///< open tags of the elements enclosing the current scan position
+};
+
+
+/// \class XMLParallelSelect
+/// \brief XML path selection on a memory resident or memory mapped document with the document split into chunks processed in parallel
+/// \remark The document is split in front of elements at a configurable depth (e.g. in front of the record elements below the root element). Each chunk is processed by an XMLScanner and an XMLPathSelect of its own, primed with the open tags of the ancestors of the chunk. The selected elements are returned in document order.
+/// \tparam CharSet character set encoding of the document, the selected elements and the automaton (UTF-8 or IsoLatin)
+template <class CharSet>
+class XMLParallelSelect
+	:public throws_exception
+{
+public:
+	typedef XMLPathSelectAutomaton<CharSet> Automaton;
+	typedef XMLScanner<SrcIterator,CharSet,CharSet,std::string> Scanner;
+	typedef XMLPathSelect<CharSet> Selector;
+
+	/// \class Element
+	/// \brief Element selected
+	struct Element
+	{
+		int type;				///< type (typeidx) of the selected element as assigned in the automaton
+		XMLScannerBase::ElementType elemtype;	///< XML element type
+		std::size_t position;			///< position of the element in the document
+		const char* content;			///< content of the element (not null terminated)
+		std::size_t size;			///< size of the content of the element in bytes
+	};
+
+	/// \brief Constructor
+	/// \param [in] atm automaton defining the XML path expressions to select
+	/// \param [in] nofThreads number of threads to use (0 for the number of cores)
+	/// \param [in] splitDepth depth of the elements in front of which the document can be split (1 for the children of the root element)
+	/// \param [in] minChunkSize minimum size of a chunk processed by one thread in bytes
+	XMLParallelSelect( const Automaton* atm, unsigned int nofThreads=0, unsigned int splitDepth=1, std::size_t minChunkSize=1<<20)
+		:m_atm(atm),m_nofThreads(nofThreads?nofThreads:hardwareConcurrency()),m_splitDepth(splitDepth),m_minChunkSize(minChunkSize),m_error(0),m_errorpos(0){}
+
+	/// \brief Destructor
+	~XMLParallelSelect()
+	{
+		clear();
+	}
+
+	/// \brief Get the number of threads that run in parallel on this machine
+	static unsigned int hardwareConcurrency()
+	{
+#if defined(TEXTWOLF_HAS_THREADS)
+		unsigned int rt = std::thread::hardware_concurrency();
+		return rt?rt:1;
+#else
+		return 1;
+#endif
+	}
+
+	/// \brief Run the selection on a document
+	/// \remark The document has to stay valid as long as the result is accessed
+	/// \param [in] src pointer to the document
+	/// \param [in] srcsize size of the document in bytes
+	/// \return true on success, false if an error occurred (the result then contains the elements selected before the error, see getError(std::size_t*))
+	bool run( const char* src, std::size_t srcsize)
+	{
+		clear();
+		m_src = src;
+		std::size_t chunksize = srcsize / m_nofThreads + 1;
+		if (chunksize < m_minChunkSize) chunksize = m_minChunkSize;
+
+		// ... start each chunk as soon as the point where the following chunk starts is known
+		XMLSplitScanner splitter( src, srcsize, m_splitDepth);
+		Chunk* chunk = new Chunk( m_atm, src, 0);
+		m_chunks.push_back( chunk);
+		std::size_t splitpos;
+		std::vector<XMLSplitScanner::Range> ancestors;
+		while (splitter.next( chunk->start + chunksize, splitpos, ancestors))
+		{
+			chunk->end = splitpos;
+			start( chunk);
+			chunk = new Chunk( m_atm, src, splitpos);
+			chunk->ancestors = ancestors;
+			m_chunks.push_back( chunk);
+		}
+		chunk->end = srcsize;
+		start( chunk);
+		join();
+		return merge();
+	}
+
+	/// \brief Get the elements selected in document order
+	const std::vector<Element>& result() const
+	{
+		return m_result;
+	}
+
+	/// \brief Get the error of the last run
+	/// \param [out] pos position of the error in the document
+	/// \return the error message or NULL if no error occurred
+	const char* getError( std::size_t* pos=0) const
+	{
+		if (pos) *pos = m_errorpos;
+		return m_error;
+	}
+
+private:
+	XMLParallelSelect( const XMLParallelSelect&){}		//non copyable
+	void operator=( const XMLParallelSelect&){}		//non copyable
+
+	/// \class Item
+	/// \brief Element selected in a chunk with its content referenced by offset
+	struct Item
+	{
+		int type;				///< type (typeidx) of the selected element
+		XMLScannerBase::ElementType elemtype;	///< XML element type
+		std::size_t position;			///< position of the element in the document
+		bool inbuf;				///< true, if the content is in the chunk buffer, false if it is in the source
+		std::size_t ofs;			///< offset of the content in the chunk buffer or in the source
+		std::size_t size;			///< size of the content in bytes
+	};
+
+	/// \class Chunk
+	/// \brief Part of the document processed by one thread
+	struct Chunk
+	{
+		const Automaton* atm;				///< automaton defining the selection
+		const char* src;				///< source document
+		std::size_t start;				///< start offset of the chunk in the source
+		std::size_t end;				///< end offset of the chunk in the source
+		std::vector<XMLSplitScanner::Range> ancestors;	///< ranges of the open tags of the elements enclosing the chunk
+		std::string buf;				///< buffer for the content of elements not referring to the source
+		std::vector<Item> items;			///< elements selected
+		const char* error;				///< error message or NULL
+		std::size_t errorpos;				///< position of the error in the document
+#if defined(TEXTWOLF_HAS_THREADS)
+		std::thread thread;				///< thread processing the chunk
+#endif
+
+		Chunk( const Automaton* atm_, const char* src_, std::size_t start_)
+			:atm(atm_),src(src_),start(start_),end(start_),error(0),errorpos(0){}
+
+		/// \brief Feed the open tags of the elements enclosing the chunk to the selector without producing results
+		void prime( Selector& selector)
+		{
+			std::vector<XMLSplitScanner::Range>::const_iterator ai = ancestors.begin(), ae = ancestors.end();
+			for (; ai != ae; ++ai)
+			{
+				Scanner scanner( SrcIterator( src + ai->start, ai->end - ai->start));
+				for (;;)
+				{
+					XMLScannerBase::ElementType et = scanner.nextItem();
+					if (et == XMLScannerBase::Exit || et == XMLScannerBase::ErrorOccurred || et == XMLScannerBase::None) break;
+					typename Selector::iterator si = selector.push( et, scanner.getItemPtr(), scanner.getItemSize()), se = selector.end();
+					for (; si != se; ++si){}
+				}
+			}
+		}
+
+		/// \brief Process the chunk
+		void run()
+		{
+			try
+			{
+				Selector selector( atm);
+				prime( selector);
+
+				Scanner scanner( SrcIterator( src + start, end - start));
+				scanner.setZeroCopy();
+				for (;;)
+				{
+					XMLScannerBase::ElementType et = scanner.nextItem();
+					if (et == XMLScannerBase::Exit) break;
+					if (et == XMLScannerBase::ErrorOccurred)
+					{
+						scanner.getError( &error);
+						errorpos = start + scanner.getPosition();
+						break;
+					}
+					const char* ptr = scanner.getItemPtr();
+					std::size_t size = scanner.getItemSize();
+					typename Selector::iterator si = selector.push( et, ptr, size), se = selector.end();
+					for (; si != se; ++si)
+					{
+						Item item;
+						item.type = *si;
+						item.elemtype = et;
+						item.position = start + scanner.getTokenPosition();
+						item.size = size;
+						if (ptr >= src + start && ptr + size <= src + end)
+						{
+							item.inbuf = false;
+							item.ofs = ptr - src;
+						}
+						else
+						{
+							item.inbuf = true;
+							item.ofs = buf.size();
+							buf.append( ptr, size);
+						}
+						items.push_back( item);
+					}
+				}
+			}
+			catch (const std::bad_alloc&)
+			{
+				error = "out of memory";
+				errorpos = start;
+			}
+			catch (const std::exception&)
+			{
+				error = "exception in XML path selection";
+				errorpos = start;
+			}
+		}
+
+		static void runChunk( Chunk* chunk)
+		{
+			chunk->run();
+		}
+	};
+
+	/// \brief Start processing a chunk
+	void start( Chunk* chunk)
+	{
+#if defined(TEXTWOLF_HAS_THREADS)
+		if (m_nofThreads > 1)
+		{
+			chunk->thread = std::thread( &Chunk::runChunk, chunk);
+			return;
+		}
+#endif
+		chunk->run();
+	}
+
+	/// \brief Wait for all chunks to be processed
+	void join()
+	{
+#if defined(TEXTWOLF_HAS_THREADS)
+		typename std::vector<Chunk*>::iterator ci = m_chunks.begin(), ce = m_chunks.end();
+		for (; ci != ce; ++ci)
+		{
+			if ((*ci)->thread.joinable()) (*ci)->thread.join();
+		}
+#endif
+	}
+
+	/// \brief Merge the elements selected in the chunks in document order
+	/// \return true on success, false if an error occurred in one of the chunks
+	bool merge()
+	{
+		std::size_t nofitems = 0;
+		typename std::vector<Chunk*>::const_iterator ci = m_chunks.begin(), ce = m_chunks.end();
+		for (; ci != ce; ++ci) nofitems += (*ci)->items.size();
+		m_result.reserve( nofitems);
+
+		for (ci = m_chunks.begin(); ci != ce; ++ci)
+		{
+			typename std::vector<Item>::const_iterator ii = (*ci)->items.begin(), ie = (*ci)->items.end();
+			for (; ii != ie; ++ii)
+			{
+				Element elem;
+				elem.type = ii->type;
+				elem.elemtype = ii->elemtype;
+				elem.position = ii->position;
+				elem.content = ii->inbuf ? ((*ci)->buf.c_str() + ii->ofs) : (m_src + ii->ofs);
+				elem.size = ii->size;
+				m_result.push_back( elem);
+			}
+			if ((*ci)->error)
+			{
+				m_error = (*ci)->error;
+				m_errorpos = (*ci)->errorpos;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// \brief Free the result of the last run
+	void clear()
+	{
+		join();
+		typename std::vector<Chunk*>::iterator ci = m_chunks.begin(), ce = m_chunks.end();
+		for (; ci != ce; ++ci) delete *ci;
+		m_chunks.clear();
+		m_result.clear();
+		m_error = 0;
+		m_errorpos = 0;
+	}
+
+private:
+	const Automaton* m_atm;			///< automaton defining the selection
+	unsigned int m_nofThreads;		///< number of threads to use
+	unsigned int m_splitDepth;		///< depth of the elements in front of which the document can be split
+	std::size_t m_minChunkSize;		///< minimum size of a chunk in bytes
+	const char* m_src;			///< source document of the last run
+	std::vector<Chunk*> m_chunks;		///< chunks of the last run
+	std::vector<Element> m_result;		///< elements selected in the last run
+	const char* m_error;			///< error of the last run or NULL
+	std::size_t m_errorpos;			///< position of the error of the last run
+};
+
+}//namespace
+#endif
@@ -15,6 +15,8 @@
 #include "textwolf/exception.hpp"
 #include "textwolf/xmlscanner.hpp"
 #include "textwolf/staticbuffer.hpp"
+#include "textwolf/symboltable.hpp"
+#include "textwolf/binaryimage.hpp"
 #include <limits>
 #include <iostream>
 #include <sstream>
@@ -22,6 +24,8 @@
 #include <vector>
 #include <map>
 #include <cstddef>
+#include <cstring>
+#include <algorithm>
 #include <stdexcept>
 
 namespace textwolf {
@@ -221,17 +225,18 @@ public:
 		unsigned int keysize;		//< key size of the element
 		char* key;			//< key of the element
 		char* srckey;			//< key of the element as in source (for debugging or reporting, etc.)
+		int keysym;			//< identifier of the key in the symbol table of the automaton (see symbols()) or 0, if the state has no key
 		int next;			//< follow state
 		int link;			//< alternative state to check
 
 		///\brief Constructor
 		State()
-			:keysize(0),key(0),srckey(0),next(-1),link(-1) {}
+			:keysize(0),key(0),srckey(0),keysym(0),next(-1),link(-1) {}
 
 		///\brief Copy constructor
 		///\param [in] orig element to copy
 		State( const State& orig)
-			:core(orig.core),keysize(orig.keysize),key(0),srckey(0),next(orig.next),link(orig.link)
+			:core(orig.core),keysize(orig.keysize),key(0),srckey(0),keysym(orig.keysym),next(orig.next),link(orig.link)
 		{
 			defineKey( orig.keysize, orig.key, orig.srckey);
 		}
@@ -285,10 +290,12 @@ public:
 		///\param[in] p_srckey the source form of the key (ASCII with encoded entities for everything else)
 		///\param[in] p_next follow state on a match
 		///\param[in] p_follow true if the search reaches all included follow scopes of the definition scope
-		void defineNext( Operation op, unsigned int p_keysize, const char* p_key, const char* p_srckey, int p_next, bool p_follow=false)
+		///\param[in] p_keysym identifier of the key in the symbol table of the automaton
+		void defineNext( Operation op, unsigned int p_keysize, const char* p_key, const char* p_srckey, int p_next, bool p_follow=false, int p_keysym=0)
 		{
 			core.mask.seekop( op);
 			defineKey( p_keysize, p_key, p_srckey);
+			keysym = p_keysym;
 			next = p_next;
 			core.follow = p_follow;
 		}
@@ -337,7 +344,7 @@ public:
 			}
 			if (core.cnt_end > 0)
 			{
-				rt << '[' << core.cnt_start << ',' << rt << core.cnt_end << ']';
+				rt << '[' << core.cnt_start << ',' << core.cnt_end << ']';
 			}
 			if (core.typeidx)
 			{
@@ -430,6 +437,685 @@ public:
 		Scope()					{}
 	};
 
+	///\class CompiledIndex
+	///\brief Index of the tokens expanded from a link chain of states (see XMLPathSelect::expand(int)) that have to be visited for an element by its type and key symbol, so that the tokens not matching are not visited at all
+	///\remark The tokens are addressed by their offset relative to the first token expanded from the chain. States without key, states with output and states rejecting an element type are visited for any key. Masks of tokens can only be reset during processing, so the index stays valid for all tokens.
+	class CompiledIndex
+	{
+	public:
+		///\class Candidates
+		///\brief Two ascending lists of token offsets to visit for an element
+		struct Candidates
+		{
+			const unsigned int* visit;		//< start of the offsets of tokens to visit for any key
+			const unsigned int* visitEnd;		//< end of the offsets of tokens to visit for any key
+			const unsigned int* keyed;		//< start of the offsets of tokens with a key equal to the key of the element
+			const unsigned int* keyedEnd;		//< end of the offsets of tokens with a key equal to the key of the element
+
+			///\brief Constructor
+			Candidates()				:visit(0),visitEnd(0),keyed(0),keyedEnd(0) {}
+
+			///\brief Get the next offset of a token to visit in ascending order
+			///\param[out] ofs the offset of the token
+			///\return false, if there are no tokens left to visit
+			bool next( unsigned int& ofs)
+			{
+				if (visit != visitEnd)
+				{
+					if (keyed != keyedEnd && *keyed < *visit)
+					{
+						ofs = *keyed++;
+					}
+					else
+					{
+						ofs = *visit++;
+					}
+					return true;
+				}
+				if (keyed != keyedEnd)
+				{
+					ofs = *keyed++;
+					return true;
+				}
+				return false;
+			}
+		};
+
+		///\brief Constructor
+		CompiledIndex()
+			:m_mask(0){}
+
+		///\brief Find out if the index has been built
+		///\return true, if yes
+		bool defined() const
+		{
+			return !m_chainslot.empty();
+		}
+
+		///\brief Drop the index
+		void clear()
+		{
+			m_chainslot.clear();
+			m_visitofs.clear();
+			m_offsets.clear();
+			m_entries.clear();
+			m_mask = 0;
+		}
+
+		///\brief Get the tokens to visit for an element
+		///\param[in] stateidx index of the first state of the link chain the tokens were expanded from
+		///\param[in] type type of the element
+		///\param[in] keysym identifier of the key of the element in the symbol table of the automaton or 0, if it is not defined there
+		///\param[out] res the offsets of the tokens to visit
+		void lookup( int stateidx, XMLScannerBase::ElementType type, int keysym, Candidates& res) const
+		{
+			int slot = m_chainslot[ stateidx];
+			const unsigned int* offsets = m_offsets.empty()?0:&m_offsets[0];
+			std::size_t vi = (std::size_t)slot * XMLScannerBase::NofElementTypes + (unsigned int)type;
+			res.visit = offsets + m_visitofs[ vi];
+			res.visitEnd = offsets + m_visitofs[ vi+1];
+			res.keyed = res.keyedEnd = 0;
+			if (!keysym) return;
+
+			for (unsigned int ei = hash( slot, type, keysym) & m_mask;; ei = (ei + 1) & m_mask)
+			{
+				const Entry& entry = m_entries[ ei];
+				if (entry.slot == -1) return;
+				if (entry.keysym == keysym && entry.slot == slot && entry.type == (unsigned short)type)
+				{
+					res.keyed = offsets + entry.start;
+					res.keyedEnd = offsets + entry.end;
+					return;
+				}
+			}
+		}
+
+		///\brief Build the index for the states of an automaton
+		///\param[in] states states of the automaton
+		void build( const std::vector<State>& states)
+		{
+			clear();
+			m_chainslot.resize( states.size(), -1);
+			std::vector<int> heads;
+			if (!states.empty()) addHead( heads, 0);
+			for (std::size_t si=0; si<states.size(); ++si)
+			{
+				if (states[ si].next >= 0) addHead( heads, states[ si].next);
+			}
+			std::vector<KeyedToken> keyed;
+			m_visitofs.push_back( 0);
+			for (std::size_t hi=0; hi<heads.size(); ++hi)
+			{
+				for (unsigned int tt=0; tt<XMLScannerBase::NofElementTypes; ++tt)
+				{
+					XMLScannerBase::ElementType type = (XMLScannerBase::ElementType)tt;
+					unsigned int ofs = 0;
+					for (int si=heads[ hi]; si != -1; si=states[ si].link)
+					{
+						const State& st = states[ si];
+						if (st.core.mask.empty() && st.core.typeidx != 0) continue; //... trigger, not expanded to a token
+						if (st.core.mask.rejects( type) || (st.core.mask.matches( type) && (!st.key || st.core.typeidx != 0)))
+						{
+							m_offsets.push_back( ofs);
+						}
+						else if (st.core.mask.matches( type))
+						{
+							keyed.push_back( KeyedToken( hi, type, st.keysym, ofs));
+						}
+						++ofs;
+					}
+					m_visitofs.push_back( m_offsets.size());
+				}
+			}
+			// ... group the tokens with a key by chain, type and key and insert the groups into the hash table
+			std::sort( keyed.begin(), keyed.end());
+			std::vector<Entry> groups;
+			std::size_t ki = 0;
+			while (ki < keyed.size())
+			{
+				Entry entry;
+				entry.slot = keyed[ ki].slot;
+				entry.type = keyed[ ki].type;
+				entry.keysym = keyed[ ki].keysym;
+				entry.start = m_offsets.size();
+				std::size_t ke = ki;
+				for (; ke < keyed.size() && keyed[ ki].sameKey( keyed[ ke]); ++ke)
+				{
+					m_offsets.push_back( keyed[ ke].ofs);
+				}
+				entry.end = m_offsets.size();
+				groups.push_back( entry);
+				ki = ke;
+			}
+			std::size_t tabsize = 16;
+			while (tabsize < groups.size() * 2) tabsize *= 2;
+			m_mask = tabsize - 1;
+			m_entries.resize( tabsize);
+			for (std::size_t gi=0; gi<groups.size(); ++gi)
+			{
+				unsigned int ei = hash( groups[ gi].slot, (XMLScannerBase::ElementType)groups[ gi].type, groups[ gi].keysym) & m_mask;
+				while (m_entries[ ei].slot != -1) ei = (ei + 1) & m_mask;
+				m_entries[ ei] = groups[ gi];
+			}
+		}
+
+		///\brief Write the index to a binary image
+		///\param[in,out] out writer of the image
+		void serialize( BinaryImageWriter& out) const
+		{
+			out.words( m_chainslot);
+			out.words( m_visitofs);
+			out.words( m_offsets);
+			std::vector<unsigned int> entries;
+			typename std::vector<Entry>::const_iterator ei = m_entries.begin(), ee = m_entries.end();
+			for (; ei != ee; ++ei)
+			{
+				entries.push_back( (unsigned int)ei->slot);
+				entries.push_back( ei->type);
+				entries.push_back( (unsigned int)ei->keysym);
+				entries.push_back( (unsigned int)ei->start);
+				entries.push_back( (unsigned int)ei->end);
+			}
+			out.words( entries);
+			out.word( m_mask);
+		}
+
+		///\brief Load the index from a binary image written with serialize(BinaryImageWriter&)const
+		///\param[in,out] in reader of the image
+		///\param[in] states states of the automaton the index was built for (with link chains already checked to be free of cycles)
+		void load( BinaryImageReader& in, const std::vector<State>& states)
+		{
+			CompiledIndex rt;
+			in.words( rt.m_chainslot);
+			in.words( rt.m_visitofs);
+			in.words( rt.m_offsets);
+			std::vector<unsigned int> entries;
+			in.words( entries);
+			rt.m_mask = in.word();
+
+			// ... check all indices used by lookup(int,XMLScannerBase::ElementType,int,Candidates&) const
+			std::size_t nofSlots = rt.m_visitofs.empty() ? 0 : (rt.m_visitofs.size() - 1) / XMLScannerBase::NofElementTypes;
+			if (rt.m_chainslot.size() != states.size() || nofSlots == 0
+			||  rt.m_visitofs.size() != nofSlots * XMLScannerBase::NofElementTypes + 1
+			||  entries.size() != ((std::size_t)rt.m_mask + 1) * 5
+			||  (rt.m_mask & (rt.m_mask + 1)) != 0)
+			{
+				throw exception( InvalidImage);
+			}
+			// ... every chain expanded by XMLPathSelect::expand(int) has a slot, the offsets of a slot address the tokens expanded from its chain
+			std::vector<unsigned int> nofTokens( nofSlots, 0);
+			std::vector<bool> assigned( nofSlots, false);
+			for (std::size_t si=0; si<rt.m_chainslot.size(); ++si)
+			{
+				int slot = rt.m_chainslot[ si];
+				if (slot < -1 || slot >= (int)nofSlots) throw exception( InvalidImage);
+				if (slot == -1) continue;
+				if (assigned[ slot]) throw exception( InvalidImage);
+				assigned[ slot] = true;
+				nofTokens[ slot] = chainTokens( states, (int)si);
+			}
+			if (!states.empty() && rt.m_chainslot[ 0] == -1) throw exception( InvalidImage);
+			for (std::size_t si=0; si<states.size(); ++si)
+			{
+				if (states[ si].next >= 0 && rt.m_chainslot[ states[ si].next] == -1) throw exception( InvalidImage);
+			}
+			for (std::size_t vi=0; vi<rt.m_visitofs.size(); ++vi)
+			{
+				if ((vi > 0 && rt.m_visitofs[ vi] < rt.m_visitofs[ vi-1]) || rt.m_visitofs[ vi] > rt.m_offsets.size()) throw exception( InvalidImage);
+			}
+			for (std::size_t slot=0; slot<nofSlots; ++slot)
+			{
+				std::size_t vi = slot * XMLScannerBase::NofElementTypes;
+				checkOffsets( rt.m_offsets, rt.m_visitofs[ vi], rt.m_visitofs[ vi + XMLScannerBase::NofElementTypes], nofTokens[ slot]);
+			}
+			// ... the hash table needs an empty entry to end the search of a key not defined
+			bool hasEmptyEntry = false;
+			rt.m_entries.resize( rt.m_mask + 1);
+			for (std::size_t ei=0; ei<rt.m_entries.size(); ++ei)
+			{
+				Entry& entry = rt.m_entries[ ei];
+				entry.slot = (int)entries[ ei*5+0];
+				entry.type = (unsigned short)entries[ ei*5+1];
+				entry.keysym = (int)entries[ ei*5+2];
+				entry.start = entries[ ei*5+3];
+				entry.end = entries[ ei*5+4];
+				if (entry.slot == -1)
+				{
+					hasEmptyEntry = true;
+					continue;
+				}
+				if (entry.slot < 0 || entry.slot >= (int)nofSlots || entry.start > entry.end || entry.end > rt.m_offsets.size())
+				{
+					throw exception( InvalidImage);
+				}
+				checkOffsets( rt.m_offsets, entry.start, entry.end, nofTokens[ entry.slot]);
+			}
+			if (!hasEmptyEntry) throw exception( InvalidImage);
+			*this = rt;
+		}
+
+	private:
+		///\class Entry
+		///\brief Entry of the hash table of tokens with a key
+		struct Entry
+		{
+			int slot;				//< index of the link chain or -1 for an empty entry
+			unsigned short type;			//< element type
+			int keysym;				//< identifier of the key
+			std::size_t start;			//< start of the token offsets in m_offsets
+			std::size_t end;			//< end of the token offsets in m_offsets
+
+			Entry()	:slot(-1),type(0),keysym(0),start(0),end(0) {}
+		};
+
+		///\class KeyedToken
+		///\brief Token with a key matching an element type, used while building the index
+		struct KeyedToken
+		{
+			int slot;				//< index of the link chain
+			unsigned short type;			//< element type
+			int keysym;				//< identifier of the key
+			unsigned int ofs;			//< offset of the token in the chain
+
+			KeyedToken( int p_slot, XMLScannerBase::ElementType p_type, int p_keysym, unsigned int p_ofs)
+				:slot(p_slot),type((unsigned short)p_type),keysym(p_keysym),ofs(p_ofs){}
+
+			///\brief Compare by chain, element type and key only
+			bool sameKey( const KeyedToken& o) const
+			{
+				return slot == o.slot && type == o.type && keysym == o.keysym;
+			}
+
+			///\brief Order by chain, element type, key and offset
+			bool operator<( const KeyedToken& o) const
+			{
+				if (slot != o.slot) return slot < o.slot;
+				if (type != o.type) return type < o.type;
+				if (keysym != o.keysym) return keysym < o.keysym;
+				return ofs < o.ofs;
+			}
+		};
+
+		///\brief Declare a state as first state of a link chain
+		void addHead( std::vector<int>& heads, int stateidx)
+		{
+			if (m_chainslot[ stateidx] == -1)
+			{
+				m_chainslot[ stateidx] = heads.size();
+				heads.push_back( stateidx);
+			}
+		}
+
+		///\brief Get the number of tokens expanded from a link chain (see XMLPathSelect::expand(int))
+		static unsigned int chainTokens( const std::vector<State>& states, int stateidx)
+		{
+			unsigned int rt = 0;
+			for (int si=stateidx; si != -1; si=states[ si].link)
+			{
+				const State& st = states[ si];
+				if (!st.core.mask.empty() || st.core.typeidx == 0) ++rt;
+			}
+			return rt;
+		}
+
+		///\brief Check that the token offsets in a range of an index loaded address tokens of the chain
+		static void checkOffsets( const std::vector<unsigned int>& offsets, std::size_t start, std::size_t end, unsigned int nofTokens)
+		{
+			for (std::size_t oi=start; oi<end; ++oi)
+			{
+				if (offsets[ oi] >= nofTokens) throw exception( InvalidImage);
+			}
+		}
+
+		///\brief Hash function for chain, element type and key
+		static unsigned int hash( int slot, XMLScannerBase::ElementType type, int keysym)
+		{
+			unsigned int rt = ((unsigned int)slot * 16 + (unsigned int)type) * 2654435761U ^ (unsigned int)keysym * 40503U;
+			return rt ^ (rt >> 15);
+		}
+
+		std::vector<int> m_chainslot;			//< index of the link chain by index of its first state or -1
+		std::vector<std::size_t> m_visitofs;		//< start of the offsets of tokens to visit for any key by chain and element type in m_offsets
+		std::vector<unsigned int> m_offsets;		//< lists of token offsets
+		std::vector<Entry> m_entries;			//< hash table of the tokens with a key by chain, element type and key
+		unsigned int m_mask;				//< size of the hash table minus one (size is a power of two)
+	};
+
+	///\brief Build the index for visiting only the tokens that can match an element in XMLPathSelect instead of all of the active scope
+	///\remark Should be called after the last expression has been defined, any definition added afterwards drops the index
+	void compile()
+	{
+		try
+		{
+			m_index.build( states);
+		}
+		catch (const std::bad_alloc&)
+		{
+			throw exception( OutOfMem);
+		}
+	}
+
+	///\brief Get the element types any state of the automaton can match
+	///\remark Elements of other types never take part in a selection, so their content does not have to be built (see XMLScanner::nextItem(unsigned short))
+	///\return the bitmask of element types (bit 1<<type set for an element type matched)
+	unsigned short matchMask() const
+	{
+		unsigned short rt = 0;
+		typename std::vector<State>::const_iterator ii=states.begin(), ee=states.end();
+		for (; ii != ee; ++ii) rt |= ii->core.mask.pos;
+		return rt;
+	}
+
+	///\brief Get the table of the keys of all states interned
+	///\remark Pass it to XMLScanner::setSymbolTable(const SymbolTable*) to get the element keys resolved by the scanner
+	///\return the symbol table
+	const SymbolTable& symbols() const
+	{
+		return m_symbols;
+	}
+
+	///\brief Get the index built with compile()
+	///\return the index or NULL if the automaton has not been compiled
+	const CompiledIndex* compiledIndex() const
+	{
+		return m_index.defined()?&m_index:0;
+	}
+
+	///\brief Get a binary image of the automaton with its symbol table and its index built with compile(), if defined
+	///\remark The image contains no pointers and can be written to a file once and loaded with load(const void*,std::size_t) instead of defining the automaton from its expressions again. It can only be loaded by an automaton with the same character set on a platform with the same byte order and size of an int.
+	///\return the image
+	std::string serialize() const
+	{
+		try
+		{
+			std::string rt;
+			BinaryImageWriter out( rt);
+			out.word( ImageMagic);
+			out.word( ImageVersion);
+			out.word( (unsigned int)m_symbols.size());
+			for (std::size_t ii=1; ii<=m_symbols.size(); ++ii)
+			{
+				out.bytes( m_symbols.key( (int)ii), m_symbols.keysize( (int)ii));
+			}
+			out.word( (unsigned int)states.size());
+			typename std::vector<State>::const_iterator si = states.begin(), se = states.end();
+			for (; si != se; ++si)
+			{
+				out.word( si->core.mask.pos);
+				out.word( si->core.mask.neg);
+				out.word( si->core.follow?1:0);
+				out.word( (unsigned int)si->core.typeidx);
+				out.word( (unsigned int)si->core.cnt_start);
+				out.word( (unsigned int)si->core.cnt_end);
+				out.word( (unsigned int)si->keysym);
+				out.word( (unsigned int)si->next);
+				out.word( (unsigned int)si->link);
+				out.word( si->srckey?1:0);
+				if (si->srckey) out.bytes( si->srckey, std::strlen( si->srckey));
+			}
+			out.word( m_index.defined()?1:0);
+			if (m_index.defined()) m_index.serialize( out);
+			return rt;
+		}
+		catch (const std::bad_alloc&)
+		{
+			throw exception( OutOfMem);
+		}
+	}
+
+	///\brief Replace the definition of the automaton by a binary image created with serialize()const
+	///\remark The image is deserialized, the symbol table and the states are rebuilt with copies of their keys, so the image can be released after the call. This is faster than defining the automaton from its expressions again, because the keys of the states are the symbols of the image and loading does not search for transitions or intern any key twice, but it takes time and memory linear in the size of the automaton. Every automaton loaded has its own copy of the states.
+	///\param[in] image pointer to the image
+	///\param[in] imagesize size of the image in bytes
+	void load( const void* image, std::size_t imagesize)
+	{
+		try
+		{
+			BinaryImageReader in( image, imagesize);
+			if (in.word() != ImageMagic || in.word() != ImageVersion) throw exception( InvalidImage);
+
+			SymbolTable symbols;
+			std::size_t nofSymbols = in.word();
+			for (std::size_t ii=1; ii<=nofSymbols; ++ii)
+			{
+				std::size_t keysize;
+				const char* key = in.bytes( keysize);
+				if (symbols.insert( key, keysize) != (int)ii) throw exception( InvalidImage);
+			}
+			std::size_t nofStates = in.word();
+			if (nofStates > imagesize / (10 * sizeof(unsigned int))) throw exception( InvalidImage);
+			std::vector<State> st( nofStates);
+			std::string srckey;
+			for (std::size_t ii=0; ii<nofStates; ++ii)
+			{
+				State& state = st[ ii];
+				state.core.mask.pos = (unsigned short)in.word();
+				state.core.mask.neg = (unsigned short)in.word();
+				state.core.follow = (in.word() != 0);
+				state.core.typeidx = (int)in.word();
+				state.core.cnt_start = (int)in.word();
+				state.core.cnt_end = (int)in.word();
+				state.keysym = (int)in.word();
+				state.next = (int)in.word();
+				state.link = (int)in.word();
+				if ((state.keysym < 0) || (state.keysym > (int)nofSymbols)
+				||  (state.next < -1) || (state.next >= (int)nofStates)
+				||  (state.link < -1) || (state.link >= (int)nofStates))
+				{
+					throw exception( InvalidImage);
+				}
+				bool hasSrckey = (in.word() != 0);
+				if (hasSrckey)
+				{
+					std::size_t srckeysize;
+					const char* srckeyptr = in.bytes( srckeysize);
+					srckey.assign( srckeyptr, srckeysize);
+				}
+				if (state.keysym)
+				{
+					state.defineKey( symbols.keysize( state.keysym), symbols.key( state.keysym), hasSrckey?srckey.c_str():0);
+				}
+				else if (hasSrckey)
+				{
+					state.defineKey( 0, 0, srckey.c_str());
+				}
+			}
+			// ... link chains are walked to their end by XMLPathSelect::expand(int), a cycle would never end
+			std::vector<unsigned char> visited( nofStates, 0);
+			for (std::size_t ii=0; ii<nofStates; ++ii)
+			{
+				int si = (int)ii;
+				for (; si != -1 && visited[ si] == 0; si=st[ si].link) visited[ si] = 1;
+				if (si != -1 && visited[ si] == 1) throw exception( InvalidImage);
+				for (si=(int)ii; si != -1 && visited[ si] == 1; si=st[ si].link) visited[ si] = 2;
+			}
+			CompiledIndex index;
+			if (in.word() != 0) index.load( in, st);
+			if (!in.eof()) throw exception( InvalidImage);
+
+			states.swap( st);
+			m_symbols = symbols;
+			m_index = index;
+			m_transitions.clear();
+		}
+		catch (const std::bad_alloc&)
+		{
+			throw exception( OutOfMem);
+		}
+	}
+
+private:
+	enum
+	{
+		ImageMagic=0x41505754,				//< first word of an image ("TWPA" in little endian byte order)
+		ImageVersion=1					//< version of the image format, incremented on every change
+	};
+
+	///\class TransitionIndex
+	///\brief Index of the state transitions defined with a key by link chain, used in the definition of the automaton to find an existing transition or the end of a link chain without walking through the chain
+	///\remark Link chains are only extended at their end, so the position of a state in its chain never changes. The index is rebuilt from the states, if their number does not match anymore (e.g. after load(const void*,std::size_t) or after states have been added directly).
+	class TransitionIndex
+	{
+	public:
+		///\brief Constructor
+		TransitionIndex()
+			:m_mask(0),m_nofEntries(0){}
+
+		///\brief Drop the index, so that it is rebuilt with the next call of update(const std::vector<State>&)
+		void clear()
+		{
+			m_head.clear();
+			m_pos.clear();
+			m_tail.clear();
+			m_entries.clear();
+			m_mask = 0;
+			m_nofEntries = 0;
+		}
+
+		///\brief Rebuild the index, if it does not describe the states passed
+		///\param[in] states states of the automaton
+		void update( const std::vector<State>& states)
+		{
+			if (m_head.size() == states.size()) return;
+			clear();
+			m_head.resize( states.size(), -1);
+			m_pos.resize( states.size(), 0);
+			m_tail.resize( states.size(), -1);
+			std::vector<bool> linked( states.size(), false);
+			for (std::size_t si=0; si<states.size(); ++si)
+			{
+				if (states[ si].link >= 0) linked[ states[ si].link] = true;
+			}
+			for (std::size_t hi=0; hi<states.size(); ++hi)
+			{
+				if (linked[ hi]) continue;
+				int pos = 0;
+				for (int si=(int)hi; si != -1 && m_head[ si] == -1; si=states[ si].link)
+				{
+					m_head[ si] = (int)hi;
+					m_pos[ si] = pos++;
+					m_tail[ hi] = si;
+					define( states, si);
+				}
+			}
+		}
+
+		///\brief Declare a state just added as the first state of a new link chain
+		///\param[in] stateidx index of the state
+		void addChain( int stateidx)
+		{
+			m_head.push_back( stateidx);
+			m_pos.push_back( 0);
+			m_tail.push_back( stateidx);
+		}
+
+		///\brief Declare a state just added as linked to the last state of a link chain
+		///\param[in] tailidx index of the last state of the link chain
+		///\param[in] stateidx index of the state
+		void addLink( int tailidx, int stateidx)
+		{
+			int head = m_head[ tailidx];
+			m_head.push_back( head);
+			m_pos.push_back( m_pos[ tailidx] + 1);
+			m_tail.push_back( -1);
+			m_tail[ head] = stateidx;
+		}
+
+		///\brief Get the last state of the link chain a state belongs to
+		///\param[in] stateidx index of the state
+		///\return the index of the last state
+		int tail( int stateidx) const
+		{
+			return m_tail[ m_head[ stateidx]];
+		}
+
+		///\brief Insert the transition of a state into the index, if it is defined with a key and not defined already by a state before in the same link chain
+		///\param[in] states states of the automaton
+		///\param[in] stateidx index of the state
+		void define( const std::vector<State>& states, int stateidx)
+		{
+			const State& st = states[ stateidx];
+			if (!st.keysym) return;
+			if ((m_nofEntries + 1) * 2 > m_entries.size()) rehash( states, m_entries.empty() ? 16 : m_entries.size() * 2);
+			int head = m_head[ stateidx];
+			unsigned int ei = hash( head, st.keysym, st.core.follow, st.core.mask) & m_mask;
+			for (; m_entries[ ei] != -1; ei = (ei + 1) & m_mask)
+			{
+				if (sameTransition( states, m_entries[ ei], head, st.keysym, st.core.follow, st.core.mask)) return;
+			}
+			m_entries[ ei] = stateidx;
+			++m_nofEntries;
+		}
+
+		///\brief Find the first state of a link chain defining a transition, starting the search at a state
+		///\param[in] states states of the automaton
+		///\param[in] stateidx index of the state to start the search with
+		///\param[in] keysym identifier of the key (not 0)
+		///\param[in] follow true, if the transition is active for all sub scopes of the activation state
+		///\param[in] mask mask of the operation of the transition
+		///\return the index of the state found or -1, if not found
+		int find( const std::vector<State>& states, int stateidx, int keysym, bool follow, const Mask& mask) const
+		{
+			if (m_entries.empty()) return -1;
+			int head = m_head[ stateidx];
+			for (unsigned int ei = hash( head, keysym, follow, mask) & m_mask; m_entries[ ei] != -1; ei = (ei + 1) & m_mask)
+			{
+				int si = m_entries[ ei];
+				if (!sameTransition( states, si, head, keysym, follow, mask)) continue;
+				if (m_pos[ si] >= m_pos[ stateidx]) return si;
+				// ... the first definition is before the state to start with, search a duplicate after it in the chain
+				for (si=stateidx; si != -1; si=states[ si].link)
+				{
+					if (sameTransition( states, si, head, keysym, follow, mask)) return si;
+				}
+				return -1;
+			}
+			return -1;
+		}
+
+	private:
+		bool sameTransition( const std::vector<State>& states, int stateidx, int head, int keysym, bool follow, const Mask& mask) const
+		{
+			const State& st = states[ stateidx];
+			return m_head[ stateidx] == head && st.keysym == keysym && st.core.follow == follow && st.core.mask.pos == mask.pos && st.core.mask.neg == mask.neg;
+		}
+
+		static unsigned int hash( int head, int keysym, bool follow, const Mask& mask)
+		{
+			unsigned int rt = ((unsigned int)head * 2654435761U) ^ ((unsigned int)keysym * 40503U) ^ ((unsigned int)mask.pos << 17) ^ (unsigned int)mask.neg ^ (follow?0x5bd1e995U:0U);
+			return rt ^ (rt >> 15);
+		}
+
+		void rehash( const std::vector<State>& states, std::size_t tabsize)
+		{
+			std::vector<int> old;
+			old.swap( m_entries);
+			m_entries.resize( tabsize, -1);
+			m_mask = tabsize - 1;
+			std::vector<int>::const_iterator oi = old.begin(), oe = old.end();
+			for (; oi != oe; ++oi)
+			{
+				if (*oi == -1) continue;
+				const State& st = states[ *oi];
+				unsigned int ei = hash( m_head[ *oi], st.keysym, st.core.follow, st.core.mask) & m_mask;
+				while (m_entries[ ei] != -1) ei = (ei + 1) & m_mask;
+				m_entries[ ei] = *oi;
+			}
+		}
+
+	private:
+		std::vector<int> m_head;			//< index of the first state of the link chain by state
+		std::vector<int> m_pos;				//< position of the state in its link chain by state
+		std::vector<int> m_tail;			//< index of the last state of the link chain by index of its first state
+		std::vector<int> m_entries;			//< hash table of the states with a key by link chain, key, follow flag and mask (-1 for an empty slot)
+		unsigned int m_mask;				//< size of the hash table minus one (size is a power of two)
+		std::size_t m_nofEntries;			//< number of states in the hash table
+	};
+
+	CompiledIndex m_index;					//< index built with compile()
+	SymbolTable m_symbols;					//< keys of all states interned
+	TransitionIndex m_transitions;				//< index of the transitions used while defining the automaton
+
 private:
 	///\brief Defines a state transition
 	///\param [in] stateidx from what source state
@@ -443,37 +1129,37 @@ private:
 	{
 		try
 		{
+			m_index.clear();
+			m_transitions.update( states);
 			State state;
 			if (states.size() == 0)
 			{
 				stateidx = states.size();
 				states.push_back( state);
+				m_transitions.addChain( stateidx);
 			}
 			Mask mask;
 			mask.seekop( op);
+			int keysym = key ? m_symbols.insert( key, keysize) : 0;
 
-			for (int ee=stateidx; ee != -1; stateidx=ee,ee=states[ee].link)
+			if (keysym != 0)
 			{
-				if ((states[ee].key != 0) && (keysize == states[ee].keysize) && (states[ee].core.follow == follow) && (mask == states[ee].core.mask))
-				{
-					unsigned int ii;
-					for (ii=0; ii<keysize && states[ee].key[ii]==key[ii]; ii++);
-					if (ii == keysize) return states[ee].next;
-				}
+				int ee = m_transitions.find( states, stateidx, keysym, follow, mask);
+				if (ee >= 0) return states[ee].next;
 			}
+			stateidx = m_transitions.tail( stateidx);
 			if (!states[ stateidx].isempty())
 			{
-				while (states[ stateidx].link >= 0)
-				{
-					stateidx = states[ stateidx].link;
-				}
 				states[ stateidx].link = states.size();
+				m_transitions.addLink( stateidx, states.size());
 				stateidx = states.size();
 				states.push_back( state);
 			}
 			states.push_back( state);
+			m_transitions.addChain( states.size()-1);
 			unsigned int lastidx = states.size()-1;
-			states[ stateidx].defineNext( op, keysize, key, srckey, lastidx, follow);
+			states[ stateidx].defineNext( op, keysize, key, srckey, lastidx, follow, keysym);
+			m_transitions.define( states, stateidx);
 			return stateidx=lastidx;
 		}
 		catch (const std::bad_alloc&)
@@ -498,24 +1184,24 @@ private:
 	{
 		try
 		{
+			m_index.clear();
+			m_transitions.update( states);
 			State state;
 			if (states.size() == 0)
 			{
 				stateidx = states.size();
 				states.push_back( state);
+				m_transitions.addChain( stateidx);
 			}
 			if ((unsigned int)stateidx >= states.size()) throw exception( IllegalParam);
 
 			if (!states[stateidx].isempty())
 			{
-				while (states[ stateidx].link >= 0)
-				{
-					stateidx = states[stateidx].link;
-				}
+				stateidx = m_transitions.tail( stateidx);
 				states[ stateidx].link = states.size();
+				m_transitions.addLink( stateidx, states.size());
 				stateidx = states.size();
 				states.push_back( state);
-				
 			}
 			states[ stateidx].defineOutput( printOpMask, typeidx, follow, start, end);
 			return stateidx;
@@ -23,6 +23,7 @@
 #include <cstddef>
 #include <iostream>
 #include <sstream>
+#include <new>
 
 namespace textwolf {
 
@@ -36,6 +37,83 @@ public:
 		:std::vector<Element>(o){}
 };
 
+/// \class FixedStack
+/// \brief Stock stack type for XMLPathSelect with a fixed maximum depth of the XML tree, e.g. XMLPathSelect<charset::UTF8,FixedStack<256>::type>
+/// \tparam MaxDepth maximum number of nested open tags
+/// \tparam MaxTokensPerLevel maximum average number of elements per open tag of each stack of the selector (tokens, follows, triggers, blocks), i.e. of states expanded by the path expressions for an open tag
+template <std::size_t MaxDepth, std::size_t MaxTokensPerLevel=4>
+struct FixedStack
+{
+	enum {Capacity=MaxDepth*MaxTokensPerLevel};	///< maximum number of elements of each stack
+
+	/// \class type
+	/// \brief Stack with its elements in a block of memory that is part of the stack, so that the stacks of a selector are in the selector object and constructing, copying, pushing, popping, resizing and clearing never allocate memory
+	/// \remark Throws DimOutOfRange if the capacity is exceeded. Allocate selectors with a big capacity on the heap.
+	template <typename Element>
+	class type :public throws_exception
+	{
+	public:
+		type()
+			:m_size(0){}
+		type( const type& o)
+			:m_size(0)
+		{
+			for (; m_size < o.m_size; ++m_size) new (at( m_size)) Element( o[ m_size]);
+		}
+		~type()
+		{
+			clear();
+		}
+
+		void push_back( const Element& e)
+		{
+			if (m_size == (std::size_t)Capacity) throw exception( DimOutOfRange);
+			new (at( m_size)) Element( e);
+			++m_size;
+		}
+		void pop_back()
+		{
+			if (m_size) at( --m_size)->~Element();
+		}
+		void resize( std::size_t n)
+		{
+			if (n > (std::size_t)Capacity) throw exception( DimOutOfRange);
+			while (m_size > n) pop_back();
+			for (; m_size < n; ++m_size) new (at( m_size)) Element();
+		}
+		void clear()
+		{
+			while (m_size) pop_back();
+		}
+
+		std::size_t size() const			{return m_size;}
+		bool empty() const				{return m_size == 0;}
+		Element& back()					{return *at( m_size-1);}
+		const Element& back() const			{return *at( m_size-1);}
+		Element& operator[]( std::size_t i)		{return *at( i);}
+		const Element& operator[]( std::size_t i) const	{return *at( i);}
+
+	private:
+		type& operator=( const type&);		//... non copyable
+
+		Element* at( std::size_t i)			{return reinterpret_cast<Element*>( m_mem.buf) + i;}
+		const Element* at( std::size_t i) const		{return reinterpret_cast<const Element*>( m_mem.buf) + i;}
+
+		/// \brief Uninitialized memory for the elements, aligned for any of them
+		union Memory
+		{
+			char buf[ Capacity * sizeof(Element)];
+			double align_double;
+			long align_long;
+			void* align_ptr;
+		};
+
+	private:
+		Memory m_mem;			//< the elements, only the first m_size of them constructed
+		std::size_t m_size;		//< number of elements used
+	};
+};
+
 /// \brief XML path select template
 /// \tparam CharSet_ character set encoding of the automaton elements
 /// \tparam StackType_ stack type used for tokens,triggers and scopes (as back insertion sequence with random access by index)
@@ -52,6 +130,19 @@ private:
 	typedef typename ThisXMLPathSelectAutomaton::Token Token;
 	typedef typename ThisXMLPathSelectAutomaton::State State;
 	typedef typename ThisXMLPathSelectAutomaton::Scope Scope;
+	typedef typename ThisXMLPathSelectAutomaton::CompiledIndex CompiledIndex;
+	typedef typename CompiledIndex::Candidates Candidates;
+
+	/// \class Block
+	/// \brief Tokens expanded from one link chain of states (only used with a compiled automaton)
+	struct Block
+	{
+		int stateidx;				//< index of the first state of the chain
+		unsigned int tokenidx;			//< index of the first token expanded from the chain
+
+		/// \brief Constructor
+		Block( int p_stateidx=-1, unsigned int p_tokenidx=0)	:stateidx(p_stateidx),tokenidx(p_tokenidx) {}
+	};
 
 	/// \class Context
 	/// \brief State variables without stacks of the automaton
@@ -60,22 +151,29 @@ private:
 		XMLScannerBase::ElementType type;	//< element type processed
 		const char* key;			//< string value of element processed
 		unsigned int keysize;			//< size of string value in bytes of element processed
+		int keysym;				//< identifier of the element processed in the symbol table of the automaton or 0, if not defined there
 		Scope scope;				//< active scope
 		unsigned int scope_iter;		//< position of currently visited token in the active scope
+		unsigned int block_iter;		//< position of the next block visited in the active scope (only used with a compiled automaton)
+		unsigned int block_tokenidx;		//< index of the first token of the block visited (only used with a compiled automaton)
+		Candidates candidates;			//< offsets of the tokens left to visit in the block visited (only used with a compiled automaton)
 
 		/// \brief Constructor
-		Context()				:type(XMLScannerBase::Content),key(0),keysize(0) {}
+		Context()				:type(XMLScannerBase::Content),key(0),keysize(0),keysym(0),scope_iter(0),block_iter(0),block_tokenidx(0) {}
 
 		/// \brief Initialization
 		/// \param [in] p_type type of the current element processed
 		/// \param [in] p_key current element processed
 		/// \param [in] p_keysize size of the key in bytes
-		void init( XMLScannerBase::ElementType p_type, const char* p_key, int p_keysize)
+		/// \param [in] p_keysym identifier of the key in the symbol table of the automaton
+		void init( XMLScannerBase::ElementType p_type, const char* p_key, int p_keysize, int p_keysym)
 		{
 			type = p_type;
 			key = p_key;
 			keysize = p_keysize;
+			keysym = p_keysym;
 			scope_iter = scope.range.tokenidx_from;
+			candidates = Candidates();
 		}
 	};
 
@@ -83,12 +181,29 @@ private:
 	StackType_<unsigned int> follows;	//< indices of tokens active in all descendant scopes
 	StackType_<int> triggers;		//< triggered elements
 	StackType_<Token> tokens;		//< list of waiting tokens
+	StackType_<Block> blocks;		//< link chains the waiting tokens were expanded from (only used with a compiled automaton)
+	const CompiledIndex* index;		//< index of the tokens to visit by element or NULL if the automaton has not been compiled
 	Context context;			//< state variables without stacks of the automaton
 
+	/// \brief Get the first block with tokens starting at or after a token index
+	/// \param [in] tokenidx the token index
+	/// \return the index of the block
+	unsigned int blockLowerBound( unsigned int tokenidx) const
+	{
+		unsigned int lo = 0, hi = blocks.size();
+		while (lo < hi)
+		{
+			unsigned int mid = (lo + hi) / 2;
+			if (blocks[ mid].tokenidx < tokenidx) lo = mid + 1; else hi = mid;
+		}
+		return lo;
+	}
+
 	/// \brief Activate a state by index
 	/// \param stateidx index of the state to activate
 	void expand( int stateidx)
 	{
+		if (index && stateidx != -1) blocks.push_back( Block( stateidx, tokens.size()));
 		while (stateidx!=-1)
 		{
 			const State& st = atm->states[ stateidx];
@@ -114,7 +229,8 @@ private:
 	/// \param [in] type type of the current element processed
 	/// \param [in] key current element processed
 	/// \param [in] keysize size of the key in bytes
-	void initProcessElement( XMLScannerBase::ElementType type, const char* key, int keysize)
+	/// \param [in] keysym identifier of the key in the symbol table of the automaton or -1, if it has to be looked up
+	void initProcessElement( XMLScannerBase::ElementType type, const char* key, int keysize, int keysym)
 	{
 		if (context.type == XMLScannerBase::OpenTag)
 		{
@@ -124,7 +240,12 @@ private:
 		}
 		context.scope.range.tokenidx_to = tokens.size();
 		context.scope.range.followidx = follows.size();
-		context.init( type, key, keysize);
+		if (keysym < 0) keysym = key ? atm->symbols().get( key, keysize) : 0;
+		context.init( type, key, keysize, keysym);
+		if (index)
+		{
+			context.block_iter = blockLowerBound( context.scope.range.tokenidx_from);
+		}
 		if (context.type == XMLScannerBase::OpenTag)
 		{
 			// first step of open scope saves the context context on stack
@@ -145,6 +266,7 @@ private:
 				scopestk.pop_back();
 				follows.resize( context.scope.range.followidx);
 				tokens.resize( context.scope.range.tokenidx_to);
+				if (index) blocks.resize( blockLowerBound( context.scope.range.tokenidx_to));
 			}
 		}
 	}
@@ -195,15 +317,10 @@ private:
 				const State& st = atm->states[ tk->stateidx];
 				if (st.key)
 				{
-					if (st.keysize == context.keysize)
+					if (st.keysym == context.keysym)
 					{
-						unsigned int ii;
-						for (ii=0; ii<context.keysize && st.key[ii] == context.key[ii]; ii++);
-						if (ii==context.keysize)
-						{
-							produce( tokenidx, st);
-							tk = &tokens[ tokenidx];
-						}
+						produce( tokenidx, st);
+						tk = &tokens[ tokenidx];
 					}
 				}
 				else
@@ -243,6 +360,25 @@ private:
 		return rt;
 	}
 
+	/// \brief Get the next token of the active scope to visit with a compiled automaton
+	/// \param [out] tokenidx index of the token
+	/// \return false, if all tokens of the active scope that can match have been visited
+	bool nextCandidate( unsigned int& tokenidx)
+	{
+		unsigned int ofs;
+		while (!context.candidates.next( ofs))
+		{
+			if (context.block_iter >= blocks.size()) return false;
+			const Block& block = blocks[ context.block_iter];
+			if (block.tokenidx >= context.scope.range.tokenidx_to) return false;
+			context.block_tokenidx = block.tokenidx;
+			index->lookup( block.stateidx, context.type, context.keysym, context.candidates);
+			++context.block_iter;
+		}
+		tokenidx = context.block_tokenidx + ofs;
+		return true;
+	}
+
 	/// \brief fetch the next matching element
 	/// \return type of the matching element
 	int fetch()
@@ -255,8 +391,23 @@ private:
 			{
 				if (context.scope_iter < context.scope.range.tokenidx_to)
 				{
-					type = match( context.scope_iter);
-					++context.scope_iter;
+					if (index)
+					{
+						unsigned int tokenidx;
+						if (nextCandidate( tokenidx))
+						{
+							type = match( tokenidx);
+						}
+						else
+						{
+							context.scope_iter = context.scope.range.tokenidx_to;
+						}
+					}
+					else
+					{
+						type = match( context.scope_iter);
+						++context.scope_iter;
+					}
 				}
 				else
 				{
@@ -289,6 +440,31 @@ private:
 		return type;
 	}
 
+	/// \brief Find out if a token in a range of the token stack can still match
+	/// \param [in] from lower bound token index
+	/// \param [in] to upper bound token index
+	/// \return true, if yes
+	bool hasActiveTokens( std::size_t from, std::size_t to) const
+	{
+		for (; from < to; ++from)
+		{
+			if (!tokens[ from].core.mask.empty()) return true;
+		}
+		return false;
+	}
+
+	/// \brief Find out if a token active in all descendant scopes can still match
+	/// \return true, if yes
+	bool hasActiveFollows() const
+	{
+		std::size_t ii = 0, nn = follows.size();
+		for (; ii < nn; ++ii)
+		{
+			if (!tokens[ follows[ ii]].core.mask.empty()) return true;
+		}
+		return false;
+	}
+
 public:
 	/// \brief Get the next states states that match to an element of a type
 	/// \tparam Buffer buffer type for the result (back insertion sequence)
@@ -321,11 +497,37 @@ public:
 		}
 	}
 
+	/// \brief Find out if nothing can be selected anymore in the subtree of the tag just opened, so that the scanner can skip it (see XMLScanner::skipSubtree())
+	/// \remark This function works only if called after iterating through the result with the iterator created with XMLPathSelect::push(..) for an OpenTag. The subtree includes the attributes, the content and the close tag of the element. After skipping it, the CloseTag returned by the scanner has to be pushed to close the scope of the element.
+	/// \return true, if no token active in the subtree or in all descendant scopes can match anymore
+	bool subtreeIsIrrelevant() const
+	{
+		if (context.type != XMLScannerBase::OpenTag || !triggers.empty()) return false;
+		return !hasActiveTokens( context.scope.range.tokenidx_to, tokens.size()) && !hasActiveFollows();
+	}
+
+	/// \brief Get the element types the next element pushed can be selected with or take part in a selection with
+	/// \remark This function works only if called after iterating through the result with the iterator created with XMLPathSelect::push(..). Pass the mask to XMLScanner::nextItem(unsigned short), so that the content of elements nobody selects is not built. It is the joined mask of the tokens of the active scope and of all follow tokens, kept with the scope, or all element types if outputs are triggered with the next element whatever its type.
+	/// \return the bitmask of element types (bit 1<<type set for an element type that can be matched)
+	unsigned short outputMask() const
+	{
+		if (!triggers.empty()) return 0xFFFF;
+		return context.scope.mask.pos;
+	}
+
+	/// \brief Find out if nothing can be selected anymore in the rest of the document, so that the scanning can be stopped
+	/// \remark This function works only if called after iterating through the result with the iterator created with XMLPathSelect::push(..)
+	/// \return true, if no token of any open scope can match anymore
+	bool selectionIsExhausted() const
+	{
+		return triggers.empty() && !hasActiveTokens( 0, tokens.size());
+	}
+
 public:
 	/// \brief Constructor
 	/// \param[in] p_atm read only ML path select automaton reference
 	XMLPathSelect( const ThisXMLPathSelectAutomaton* p_atm)
-		:atm(p_atm),scopestk(),follows(),triggers(),tokens()
+		:atm(p_atm),scopestk(),follows(),triggers(),tokens(),blocks(),index(p_atm->compiledIndex())
 	{
 		if (atm->states.size() > 0) expand(0);
 	}
@@ -333,7 +535,27 @@ public:
 	/// \brief Copy constructor
 	/// \param [in] o element to copy
 	XMLPathSelect( const XMLPathSelect& o)
-		:atm(o.atm),scopestk(o.scopestk),follows(o.follows),triggers(o.triggers),tokens(o.tokens){}
+		:atm(o.atm),scopestk(o.scopestk),follows(o.follows),triggers(o.triggers),tokens(o.tokens),blocks(o.blocks),index(o.index),context(o.context){}
+
+	/// \brief Get the automaton of the selector
+	/// \return the automaton
+	const ThisXMLPathSelectAutomaton* automaton() const
+	{
+		return atm;
+	}
+
+	/// \brief Reset the selector to its initial state for selecting from the next document
+	/// \remark The stacks are cleared without freeing their memory, so that a selector reused for many small documents does not allocate memory anymore after the first ones
+	void reset()
+	{
+		scopestk.clear();
+		follows.clear();
+		triggers.clear();
+		tokens.clear();
+		blocks.clear();
+		context = Context();
+		if (atm->states.size() > 0) expand(0);
+	}
 
 	/// \class iterator
 	/// \brief input iterator for the output of this XMLScanner
@@ -394,10 +616,11 @@ public:
 		/// \param [in] p_type XML element type to feed to XML path matcher
 		/// \param [in] p_key XML element value reference to feed to XML path matcher
 		/// \param [in] p_keysize XML element value size in bytes to feed to XML path matcher
-		iterator( ThisXMLPathSelect& p_input, XMLScannerBase::ElementType p_type, const char* p_key, int p_keysize)
+		/// \param [in] p_keysym identifier of the XML element value in the symbol table of the automaton or -1, if it has to be looked up
+		iterator( ThisXMLPathSelect& p_input, XMLScannerBase::ElementType p_type, const char* p_key, int p_keysize, int p_keysym=-1)
 				:input( &p_input)
 		{
-			input->initProcessElement( p_type, p_key, p_keysize);
+			input->initProcessElement( p_type, p_key, p_keysize, p_keysym);
 			skip();
 		}
 
@@ -457,6 +680,14 @@ public:
 		return iterator( *this, type, key, keysize);
 	}
 
+	/// \brief Feed the path selector with the next token resolved to a symbol by the scanner and get the start iterator for the results
+	/// \param [in] keysym identifier of the token in the symbol table of the automaton, as returned by XMLScanner::getItemSymbol() with the table of the automaton set (see XMLScanner::setSymbolTable(const SymbolTable*))
+	/// \return iterator pointing to the first of the selected XML path elements
+	iterator push( XMLScannerBase::ElementType type, const char* key, int keysize, int keysym)
+	{
+		return iterator( *this, type, key, keysize, keysym);
+	}
+
 	/// \brief Feed the path selector with the next token and get the start iterator for the results
 	/// \return iterator pointing to the first of the selected XML path elements
 	iterator push( XMLScannerBase::ElementType type, const std::string& key)
@@ -464,6 +695,44 @@ public:
 		return iterator( *this, type, key.c_str(), key.size());
 	}
 
+	/// \brief Feed the path selector with the next token and call a handler for every result, without creating an iterator
+	/// \tparam Handler function object called with the type of every XML path element selected (handler(int))
+	/// \param [in] type type of the token
+	/// \param [in] key pointer to the token
+	/// \param [in] keysize size of the token in bytes
+	/// \param [in] handler handler called for the results
+	template <class Handler>
+	void select( XMLScannerBase::ElementType type, const char* key, std::size_t keysize, Handler& handler)
+	{
+		select( type, key, keysize, -1, handler);
+	}
+
+	/// \brief Feed the path selector with the next token resolved to a symbol by the scanner and call a handler for every result, without creating an iterator
+	/// \tparam Handler function object called with the type of every XML path element selected (handler(int))
+	/// \param [in] type type of the token
+	/// \param [in] key pointer to the token
+	/// \param [in] keysize size of the token in bytes
+	/// \param [in] keysym identifier of the token in the symbol table of the automaton (see push(XMLScannerBase::ElementType,const char*,int,int)) or -1, if it has to be looked up
+	/// \param [in] handler handler called for the results
+	template <class Handler>
+	void select( XMLScannerBase::ElementType type, const char* key, std::size_t keysize, int keysym, Handler& handler)
+	{
+		initProcessElement( type, key, keysize, keysym);
+		try
+		{
+			for (int typeidx = fetch(); typeidx != 0; typeidx = fetch())
+			{
+				handler( typeidx);
+			}
+		}
+		catch (...)
+		{
+			closeProcessElement();
+			throw;
+		}
+		closeProcessElement();
+	}
+
 	/// \brief Get the end of results returned by 'push(XMLScannerBase::ElementType,const char*, int)'
 	/// \return the end iterator
 	iterator end()
@@ -15,7 +15,11 @@
 #include "textwolf/exception.hpp"
 #include "textwolf/textscanner.hpp"
 #include "textwolf/traits.hpp"
+#include "textwolf/entitymap.hpp"
+#include "textwolf/symboltable.hpp"
 #include <map>
+#include <vector>
+#include <string>
 #include <cstddef>
 
 namespace textwolf {
@@ -221,7 +225,9 @@ public:
 		ErrInternal,				///< internal error (textwolf implementation error)
 		ErrUnexpectedEndOfInput,		///< unexpected end of input stream
 		ErrExpectedEndOfLine,			///< expected mandatory end of line (after XML header)
-		ErrExpectedDash2			///< expected second '-' after '<!-' to start an XML comment as '<!-- ... -->'
+		ErrExpectedDash2,			///< expected second '-' after '<!-' to start an XML comment as '<!-- ... -->'
+		ErrNoElementToSkip,			///< skip of a subtree requested outside of an element (see XMLScanner::skipSubtree())
+		ErrInvalidCharacter			///< malformed character in the source (e.g. invalid UTF-8 sequence)
 	};
 
 	/// \brief Get the error code as string
@@ -229,7 +235,7 @@ public:
 	/// \return the error code as string
 	static const char* getErrorString( Error ee)
 	{
-		enum {NofErrors=16};
+		enum {NofErrors=18};
 		static const char* sError[NofErrors]
 			= {0,"illegal document attribute definition",
 				"expected open tag",
@@ -245,7 +251,9 @@ public:
 				"internal (illegal state)",
 				"unexpected end of input",
 				"expected end of line",
-				"expected 2nd '-' to complete marker for start of comment '<!--'"
+				"expected 2nd '-' to complete marker for start of comment '<!--'",
+				"no element to skip",
+				"invalid character"
 		};
 		return sError[(unsigned int)ee];
 	}
@@ -259,6 +267,10 @@ public:
 		TAGCLIM, ENTITYSL, ENTITY, ENTITYE, ENTITYID, ENTITYSQ, ENTITYDQ, ENTITYLC, 
 		COMDASH2, COMSEEKE, COMENDD2, COMENDCL, CDATA, CDATA1, CDATA2, CDATA3, EXIT
 	};
+	enum
+	{
+		NofSTMStates=EXIT+1			///< number of states of the XML scanner state machine
+	};
 
 	/// \brief Get the scanner state machine state as string
 	/// \param [in] s the state
@@ -299,6 +311,109 @@ public:
 		return name[ (unsigned int)a];
 	};
 
+	// Definition of the XML scanner state machine, the only one from which both Statemachine and stateTable() are generated:
+	// TEXTWOLF_XMLSCANNER_STM_<state>(T) lists the transitions T(control character,follow state) of a state,
+	// TEXTWOLF_XMLSCANNER_STATES(S) lists the states as S(state,other,fallback,miss,action op,action arg) in the order of STMState
+	// with NS (no state) resp. -1 for an undefined other transition, fallback, miss error or action.
+#define TEXTWOLF_XMLSCANNER_STM_START(T)		T(EndOfText,EXIT) T(EndOfLine,START) T(Cntrl,START) T(Space,START) T(Lt,STARTTAG)
+#define TEXTWOLF_XMLSCANNER_STM_STARTTAG(T)	T(EndOfLine,STARTTAG) T(Cntrl,STARTTAG) T(Space,STARTTAG) T(Questm,XTAG) T(Exclam,ENTITYSL)
+#define TEXTWOLF_XMLSCANNER_STM_XTAG(T)		T(EndOfLine,XTAGAISK) T(Cntrl,XTAGAISK) T(Space,XTAGAISK) T(Questm,XTAGEND)
+#define TEXTWOLF_XMLSCANNER_STM_PITAG(T)		T(Questm,PITAGEND)
+#define TEXTWOLF_XMLSCANNER_STM_PITAGEND(T)	T(Gt,CONTENT)
+#define TEXTWOLF_XMLSCANNER_STM_XTAGEND(T)	T(Gt,XTAGDONE) T(EndOfLine,XTAGEND) T(Cntrl,XTAGEND) T(Space,XTAGEND)
+#define TEXTWOLF_XMLSCANNER_STM_XTAGDONE(T)	
+#define TEXTWOLF_XMLSCANNER_STM_XTAGAISK(T)	T(EndOfLine,XTAGAISK) T(Cntrl,XTAGAISK) T(Space,XTAGAISK) T(Questm,XTAGEND)
+#define TEXTWOLF_XMLSCANNER_STM_XTAGANAM(T)	T(EndOfLine,XTAGAESK) T(Cntrl,XTAGAESK) T(Space,XTAGAESK) T(Equal,XTAGAVSK)
+#define TEXTWOLF_XMLSCANNER_STM_XTAGAESK(T)	T(EndOfLine,XTAGAESK) T(Cntrl,XTAGAESK) T(Space,XTAGAESK) T(Equal,XTAGAVSK)
+#define TEXTWOLF_XMLSCANNER_STM_XTAGAVSK(T)	T(EndOfLine,XTAGAVSK) T(Cntrl,XTAGAVSK) T(Space,XTAGAVSK) T(Sq,XTAGAVSQ) T(Dq,XTAGAVDQ)
+#define TEXTWOLF_XMLSCANNER_STM_XTAGAVID(T)	T(EndOfLine,XTAGAISK) T(Cntrl,XTAGAISK) T(Space,XTAGAISK) T(Questm,XTAGEND)
+#define TEXTWOLF_XMLSCANNER_STM_XTAGAVSQ(T)	T(Sq,XTAGAVQE)
+#define TEXTWOLF_XMLSCANNER_STM_XTAGAVDQ(T)	T(Dq,XTAGAVQE)
+#define TEXTWOLF_XMLSCANNER_STM_XTAGAVQE(T)	T(EndOfLine,XTAGAISK) T(Cntrl,XTAGAISK) T(Space,XTAGAISK) T(Questm,XTAGEND)
+#define TEXTWOLF_XMLSCANNER_STM_DOCSTART(T)	T(EndOfText,EXIT) T(EndOfLine,DOCSTART) T(Cntrl,DOCSTART) T(Space,DOCSTART) T(Lt,XMLTAG)
+#define TEXTWOLF_XMLSCANNER_STM_CONTENT(T)	T(EndOfText,EXIT) T(Lt,XMLTAG)
+#define TEXTWOLF_XMLSCANNER_STM_TOKEN(T)		T(EndOfText,EXIT) T(EndOfLine,CONTENT) T(Cntrl,CONTENT) T(Space,CONTENT) T(Lt,XMLTAG)
+#define TEXTWOLF_XMLSCANNER_STM_SEEKTOK(T)	T(EndOfText,EXIT) T(EndOfLine,SEEKTOK) T(Cntrl,SEEKTOK) T(Space,SEEKTOK) T(Lt,XMLTAG)
+#define TEXTWOLF_XMLSCANNER_STM_XMLTAG(T)		T(EndOfLine,XMLTAG) T(Cntrl,XMLTAG) T(Space,XMLTAG) T(Questm,PITAG) T(Exclam,ENTITYSL) T(Slash,CLOSETAG)
+#define TEXTWOLF_XMLSCANNER_STM_OPENTAG(T)	T(EndOfLine,TAGAISK) T(Cntrl,TAGAISK) T(Space,TAGAISK) T(Slash,TAGCLIM) T(Gt,CONTENT)
+#define TEXTWOLF_XMLSCANNER_STM_CLOSETAG(T)	T(EndOfLine,TAGCLSK) T(Cntrl,TAGCLSK) T(Space,TAGCLSK) T(Gt,CONTENT)
+#define TEXTWOLF_XMLSCANNER_STM_TAGCLSK(T)	T(EndOfLine,TAGCLSK) T(Cntrl,TAGCLSK) T(Space,TAGCLSK) T(Gt,CONTENT)
+#define TEXTWOLF_XMLSCANNER_STM_TAGAISK(T)	T(EndOfLine,TAGAISK) T(Cntrl,TAGAISK) T(Space,TAGAISK) T(Gt,CONTENT) T(Slash,TAGCLIM)
+#define TEXTWOLF_XMLSCANNER_STM_TAGANAM(T)	T(EndOfLine,TAGAESK) T(Cntrl,TAGAESK) T(Space,TAGAESK) T(Equal,TAGAVSK)
+#define TEXTWOLF_XMLSCANNER_STM_TAGAESK(T)	T(EndOfLine,TAGAESK) T(Cntrl,TAGAESK) T(Space,TAGAESK) T(Equal,TAGAVSK)
+#define TEXTWOLF_XMLSCANNER_STM_TAGAVSK(T)	T(EndOfLine,TAGAVSK) T(Cntrl,TAGAVSK) T(Space,TAGAVSK) T(Sq,TAGAVSQ) T(Dq,TAGAVDQ)
+#define TEXTWOLF_XMLSCANNER_STM_TAGAVID(T)	T(EndOfLine,TAGAISK) T(Cntrl,TAGAISK) T(Space,TAGAISK) T(Slash,TAGCLIM) T(Gt,CONTENT)
+#define TEXTWOLF_XMLSCANNER_STM_TAGAVSQ(T)	T(Sq,TAGAVQE)
+#define TEXTWOLF_XMLSCANNER_STM_TAGAVDQ(T)	T(Dq,TAGAVQE)
+#define TEXTWOLF_XMLSCANNER_STM_TAGAVQE(T)	T(EndOfLine,TAGAISK) T(Cntrl,TAGAISK) T(Space,TAGAISK) T(Slash,TAGCLIM) T(Gt,CONTENT)
+#define TEXTWOLF_XMLSCANNER_STM_TAGCLIM(T)	T(EndOfLine,TAGCLIM) T(Cntrl,TAGCLIM) T(Space,TAGCLIM) T(Gt,CONTENT)
+#define TEXTWOLF_XMLSCANNER_STM_ENTITYSL(T)	T(Osb,CDATA) T(Dash,COMDASH2)
+#define TEXTWOLF_XMLSCANNER_STM_ENTITY(T)		T(Gt,ENTITYE) T(EndOfLine,ENTITY) T(Cntrl,ENTITY) T(Space,ENTITY) T(Dq,ENTITYDQ) T(Sq,ENTITYSQ) T(Osb,ENTITYLC)
+#define TEXTWOLF_XMLSCANNER_STM_ENTITYE(T)	
+#define TEXTWOLF_XMLSCANNER_STM_ENTITYID(T)	T(EndOfLine,ENTITY) T(Cntrl,ENTITY) T(Space,ENTITY) T(Gt,ENTITYE)
+#define TEXTWOLF_XMLSCANNER_STM_ENTITYSQ(T)	T(Sq,ENTITY)
+#define TEXTWOLF_XMLSCANNER_STM_ENTITYDQ(T)	T(Dq,ENTITY)
+#define TEXTWOLF_XMLSCANNER_STM_ENTITYLC(T)	T(Csb,ENTITY)
+#define TEXTWOLF_XMLSCANNER_STM_COMDASH2(T)	T(Dash,COMSEEKE)
+#define TEXTWOLF_XMLSCANNER_STM_COMSEEKE(T)	T(Dash,COMENDD2)
+#define TEXTWOLF_XMLSCANNER_STM_COMENDD2(T)	T(Dash,COMENDCL)
+#define TEXTWOLF_XMLSCANNER_STM_COMENDCL(T)	T(Gt,SEEKTOK) T(Dash,COMENDD2)
+#define TEXTWOLF_XMLSCANNER_STM_CDATA(T)		T(Osb,CDATA1)
+#define TEXTWOLF_XMLSCANNER_STM_CDATA1(T)		T(Csb,CDATA2)
+#define TEXTWOLF_XMLSCANNER_STM_CDATA2(T)		T(Csb,CDATA3)
+#define TEXTWOLF_XMLSCANNER_STM_CDATA3(T)		T(Gt,CONTENT)
+#define TEXTWOLF_XMLSCANNER_STM_EXIT(T)		
+
+#define TEXTWOLF_XMLSCANNER_STATES(S)\
+	S( START,    NS,       NS,       ErrExpectedOpenTag,              -1,                     None)\
+	S( STARTTAG, NS,       OPENTAG,  -1,                              -1,                     None)\
+	S( XTAG,     NS,       NS,       ErrExpectedXMLTag,               ExpectIdentifierXML,    None)\
+	S( PITAG,    PITAG,    NS,       -1,                              -1,                     None)\
+	S( PITAGEND, NS,       NS,       ErrExpectedTagEnd,               -1,                     None)\
+	S( XTAGEND,  NS,       NS,       ErrExpectedTagEnd,               -1,                     None)\
+	S( XTAGDONE, NS,       DOCSTART, -1,                              Return,                 HeaderEnd)\
+	S( XTAGAISK, NS,       XTAGANAM, -1,                              -1,                     None)\
+	S( XTAGANAM, NS,       NS,       ErrExpectedEqual,                ReturnIdentifier,       HeaderAttribName)\
+	S( XTAGAESK, NS,       NS,       ErrExpectedEqual,                -1,                     None)\
+	S( XTAGAVSK, NS,       XTAGAVID, -1,                              -1,                     None)\
+	S( XTAGAVID, NS,       NS,       ErrExpectedTagAttribute,         ReturnIdentifier,       HeaderAttribValue)\
+	S( XTAGAVSQ, NS,       NS,       ErrStringNotTerminated,          ReturnSQString,         HeaderAttribValue)\
+	S( XTAGAVDQ, NS,       NS,       ErrStringNotTerminated,          ReturnDQString,         HeaderAttribValue)\
+	S( XTAGAVQE, NS,       NS,       ErrExpectedTagAttribute,         -1,                     None)\
+	S( DOCSTART, NS,       TOKEN,    -1,                              -1,                     None)\
+	S( CONTENT,  NS,       TOKEN,    -1,                              -1,                     None)\
+	S( TOKEN,    NS,       CONTENT,  -1,                              ReturnContent,          Content)\
+	S( SEEKTOK,  NS,       TOKEN,    -1,                              -1,                     None)\
+	S( XMLTAG,   NS,       OPENTAG,  -1,                              -1,                     None)\
+	S( OPENTAG,  NS,       NS,       ErrExpectedTagAttribute,         ReturnIdentifier,       OpenTag)\
+	S( CLOSETAG, NS,       NS,       ErrExpectedTagEnd,               ReturnIdentifier,       CloseTag)\
+	S( TAGCLSK,  NS,       NS,       ErrExpectedTagEnd,               -1,                     None)\
+	S( TAGAISK,  NS,       TAGANAM,  -1,                              -1,                     None)\
+	S( TAGANAM,  NS,       NS,       ErrExpectedEqual,                ReturnIdentifier,       TagAttribName)\
+	S( TAGAESK,  NS,       NS,       ErrExpectedEqual,                -1,                     None)\
+	S( TAGAVSK,  NS,       TAGAVID,  -1,                              -1,                     None)\
+	S( TAGAVID,  NS,       NS,       ErrExpectedTagAttribute,         ReturnIdentifier,       TagAttribValue)\
+	S( TAGAVSQ,  NS,       NS,       ErrStringNotTerminated,          ReturnSQString,         TagAttribValue)\
+	S( TAGAVDQ,  NS,       NS,       ErrStringNotTerminated,          ReturnDQString,         TagAttribValue)\
+	S( TAGAVQE,  NS,       NS,       ErrExpectedTagAttribute,         -1,                     None)\
+	S( TAGCLIM,  NS,       NS,       ErrExpectedTagEnd,               Return,                 CloseTagIm)\
+	S( ENTITYSL, NS,       ENTITY,   -1,                              -1,                     None)\
+	S( ENTITY,   NS,       ENTITYID, -1,                              -1,                     None)\
+	S( ENTITYE,  NS,       SEEKTOK,  -1,                              Return,                 DocAttribEnd)\
+	S( ENTITYID, NS,       NS,       ErrIllegalDocumentAttributeDef,  ReturnIdentifier,       DocAttribValue)\
+	S( ENTITYSQ, NS,       NS,       ErrStringNotTerminated,          ReturnSQString,         DocAttribValue)\
+	S( ENTITYDQ, NS,       NS,       ErrStringNotTerminated,          ReturnDQString,         DocAttribValue)\
+	S( ENTITYLC, ENTITYLC, NS,       -1,                              -1,                     None)\
+	S( COMDASH2, NS,       NS,       ErrExpectedDash2,                -1,                     None)\
+	S( COMSEEKE, COMSEEKE, NS,       -1,                              -1,                     None)\
+	S( COMENDD2, COMSEEKE, NS,       -1,                              -1,                     None)\
+	S( COMENDCL, COMSEEKE, NS,       -1,                              -1,                     None)\
+	S( CDATA,    NS,       NS,       ErrExpectedCDATATag,             ExpectIdentifierCDATA,  None)\
+	S( CDATA1,   CDATA1,   NS,       -1,                              -1,                     None)\
+	S( CDATA2,   CDATA1,   NS,       -1,                              -1,                     None)\
+	S( CDATA3,   CDATA1,   NS,       -1,                              -1,                     None)\
+	S( EXIT,     NS,       NS,       -1,                              Return,                 Exit)
+
 	/// \class Statemachine
 	/// \brief XML scanner state machine implementation
 	struct Statemachine :public ScannerStatemachine
@@ -306,58 +421,99 @@ public:
 		/// \brief Constructor (defines the state machine completely)
 		Statemachine()
 		{
-			(*this)
-			[ START    ](EndOfText,EXIT)(EndOfLine)(Cntrl)(Space)(Lt,STARTTAG).miss(ErrExpectedOpenTag)
-			[ STARTTAG ](EndOfLine)(Cntrl)(Space)(Questm,XTAG)(Exclam,ENTITYSL).fallback(OPENTAG)
-			[ XTAG     ].action(ExpectIdentifierXML)(EndOfLine,Cntrl,Space,XTAGAISK)(Questm,XTAGEND).miss(ErrExpectedXMLTag)
-			[ PITAG    ](Questm,PITAGEND).other(PITAG)
-			[ PITAGEND ](Gt,CONTENT).miss(ErrExpectedTagEnd)
-			[ XTAGEND  ](Gt,XTAGDONE)(EndOfLine)(Cntrl)(Space).miss(ErrExpectedTagEnd)
-			[ XTAGDONE ].action(Return,HeaderEnd).fallback(DOCSTART)
-			[ XTAGAISK ](EndOfLine)(Cntrl)(Space)(Questm,XTAGEND).fallback(XTAGANAM)
-			[ XTAGANAM ].action(ReturnIdentifier,HeaderAttribName)(EndOfLine,Cntrl,Space,XTAGAESK)(Equal,XTAGAVSK).miss(ErrExpectedEqual)
-			[ XTAGAESK ](EndOfLine)(Cntrl)(Space)(Equal,XTAGAVSK).miss(ErrExpectedEqual)
-			[ XTAGAVSK ](EndOfLine)(Cntrl)(Space)(Sq,XTAGAVSQ)(Dq,XTAGAVDQ).fallback(XTAGAVID)
-			[ XTAGAVID ].action(ReturnIdentifier,HeaderAttribValue)(EndOfLine,Cntrl,Space,XTAGAISK)(Questm,XTAGEND).miss(ErrExpectedTagAttribute)
-			[ XTAGAVSQ ].action(ReturnSQString,HeaderAttribValue)(Sq,XTAGAVQE).miss(ErrStringNotTerminated)
-			[ XTAGAVDQ ].action(ReturnDQString,HeaderAttribValue)(Dq,XTAGAVQE).miss(ErrStringNotTerminated)
-			[ XTAGAVQE ](EndOfLine,Cntrl,Space,XTAGAISK)(Questm,XTAGEND).miss(ErrExpectedTagAttribute)
-			[ DOCSTART ](EndOfText,EXIT)(EndOfLine)(Cntrl)(Space)(Lt,XMLTAG).fallback(TOKEN)
-			[ CONTENT  ](EndOfText,EXIT)(Lt,XMLTAG).fallback(TOKEN)
-			[ TOKEN    ].action(ReturnContent,Content)(EndOfText,EXIT)(EndOfLine,Cntrl,Space,CONTENT)(Lt,XMLTAG).fallback(CONTENT)
-			[ SEEKTOK  ](EndOfText,EXIT)(EndOfLine)(Cntrl)(Space)(Lt,XMLTAG).fallback(TOKEN)
-			[ XMLTAG   ](EndOfLine)(Cntrl)(Space)(Questm,PITAG)(Exclam,ENTITYSL)(Slash,CLOSETAG).fallback(OPENTAG)
-			[ OPENTAG  ].action(ReturnIdentifier,OpenTag)(EndOfLine,Cntrl,Space,TAGAISK)(Slash,TAGCLIM)(Gt,CONTENT).miss(ErrExpectedTagAttribute)
-			[ CLOSETAG ].action(ReturnIdentifier,CloseTag)(EndOfLine,Cntrl,Space,TAGCLSK)(Gt,CONTENT).miss(ErrExpectedTagEnd)
-			[ TAGCLSK  ](EndOfLine)(Cntrl)(Space)(Gt,CONTENT).miss(ErrExpectedTagEnd)
-			[ TAGAISK  ](EndOfLine)(Cntrl)(Space)(Gt,CONTENT)(Slash,TAGCLIM).fallback(TAGANAM)
-			[ TAGANAM  ].action(ReturnIdentifier,TagAttribName)(EndOfLine,Cntrl,Space,TAGAESK)(Equal,TAGAVSK).miss(ErrExpectedEqual)
-			[ TAGAESK  ](EndOfLine)(Cntrl)(Space)(Equal,TAGAVSK).miss(ErrExpectedEqual)
-			[ TAGAVSK  ](EndOfLine)(Cntrl)(Space)(Sq,TAGAVSQ)(Dq,TAGAVDQ).fallback(TAGAVID)
-			[ TAGAVID  ].action(ReturnIdentifier,TagAttribValue)(EndOfLine,Cntrl,Space,TAGAISK)(Slash,TAGCLIM)(Gt,CONTENT).miss(ErrExpectedTagAttribute)
-			[ TAGAVSQ  ].action(ReturnSQString,TagAttribValue)(Sq,TAGAVQE).miss(ErrStringNotTerminated)
-			[ TAGAVDQ  ].action(ReturnDQString,TagAttribValue)(Dq,TAGAVQE).miss(ErrStringNotTerminated)
-			[ TAGAVQE  ](EndOfLine,Cntrl,Space,TAGAISK)(Slash,TAGCLIM)(Gt,CONTENT).miss(ErrExpectedTagAttribute)
-			[ TAGCLIM  ].action(Return,CloseTagIm)(EndOfLine)(Cntrl)(Space)(Gt,CONTENT).miss(ErrExpectedTagEnd)
-			[ ENTITYSL ](Osb,CDATA)(Dash,COMDASH2).fallback(ENTITY)
-			[ ENTITY   ](Gt,ENTITYE)(EndOfLine)(Cntrl)(Space)(Dq,ENTITYDQ)(Sq,ENTITYSQ)(Osb,ENTITYLC).fallback(ENTITYID)
-			[ ENTITYE  ].action(Return,DocAttribEnd).fallback(SEEKTOK)
-			[ ENTITYID ].action(ReturnIdentifier,DocAttribValue)(EndOfLine,Cntrl,Space,ENTITY)(Gt,ENTITYE).miss(ErrIllegalDocumentAttributeDef)
-			[ ENTITYSQ ].action(ReturnSQString,DocAttribValue)(Sq,ENTITY).miss(ErrStringNotTerminated)
-			[ ENTITYDQ ].action(ReturnDQString,DocAttribValue)(Dq,ENTITY).miss(ErrStringNotTerminated)
-			[ ENTITYLC ](Csb,ENTITY).other( ENTITYLC)
-			[ COMDASH2 ](Dash,COMSEEKE).miss(ErrExpectedDash2)
-			[ COMSEEKE ](Dash,COMENDD2).other(COMSEEKE)
-			[ COMENDD2 ](Dash,COMENDCL).other(COMSEEKE)
-			[ COMENDCL ](Gt,SEEKTOK)(Dash,COMENDD2).other(COMSEEKE)
-			[ CDATA    ].action(ExpectIdentifierCDATA)(Osb,CDATA1).miss(ErrExpectedCDATATag)
-			[ CDATA1   ](Csb,CDATA2).other(CDATA1)
-			[ CDATA2   ](Csb,CDATA3).other(CDATA1)
-			[ CDATA3   ](Gt,CONTENT).other(CDATA1)
-			[ EXIT     ].action(Return,Exit);
+			enum {NS=-1};	//... no state
+#define TEXTWOLF_XMLSCANNER_STM_TRANSITION(ch,ns)	(ch,ns)
+#define TEXTWOLF_XMLSCANNER_STM_DEFINE(name,other_,fallback_,miss_,op_,arg_)\
+			(*this)[ name] TEXTWOLF_XMLSCANNER_STM_##name( TEXTWOLF_XMLSCANNER_STM_TRANSITION);\
+			if ((int)(op_) != -1) action( op_, arg_);\
+			if ((int)(miss_) != -1) miss( miss_);\
+			if ((int)(fallback_) != NS) fallback( fallback_);\
+			if ((int)(other_) != NS) other( other_);
+			TEXTWOLF_XMLSCANNER_STATES( TEXTWOLF_XMLSCANNER_STM_DEFINE)
+#undef TEXTWOLF_XMLSCANNER_STM_DEFINE
+#undef TEXTWOLF_XMLSCANNER_STM_TRANSITION
 		}
 	};
 
+	/// \class StateTableElement
+	/// \brief One state in the compiled transition table of the XML scanner state machine (see stateTable())
+	struct StateTableElement
+	{
+		signed char next[ NofControlCharacter];	///< follow state fired by an event (control character type parsed) or -1
+		signed char fallbackState;		///< state transition if the event does not match or -1
+		signed char missError;			///< error code in case of an event that does not match and there is no fallback or -1
+		signed char actionOp;			///< action executed after entering this state (STMAction) or -1
+		signed char actionArg;			///< action argument (ElementType)
+		unsigned char nofnext;			///< number of follow states defined
+	};
+
+	/// \brief Get the compiled transition table of the XML scanner state machine
+	/// \remark The table is a constant initialized aggregate generated from the same definition as Statemachine (TEXTWOLF_XMLSCANNER_STATES), so it needs no initialization at runtime
+	/// \return the table indexed by STMState
+	static const StateTableElement* stateTable()
+	{
+		enum {NS=-1};	//... no state
+#define TEXTWOLF_XMLSCANNER_STM_COL0(ch,ns)	((int)(ch)==0)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL1(ch,ns)	((int)(ch)==1)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL2(ch,ns)	((int)(ch)==2)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL3(ch,ns)	((int)(ch)==3)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL4(ch,ns)	((int)(ch)==4)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL5(ch,ns)	((int)(ch)==5)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL6(ch,ns)	((int)(ch)==6)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL7(ch,ns)	((int)(ch)==7)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL8(ch,ns)	((int)(ch)==8)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL9(ch,ns)	((int)(ch)==9)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL10(ch,ns)	((int)(ch)==10)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL11(ch,ns)	((int)(ch)==11)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL12(ch,ns)	((int)(ch)==12)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL13(ch,ns)	((int)(ch)==13)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL14(ch,ns)	((int)(ch)==14)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL15(ch,ns)	((int)(ch)==15)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL16(ch,ns)	((int)(ch)==16)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COL17(ch,ns)	((int)(ch)==17)?(int)(ns):
+#define TEXTWOLF_XMLSCANNER_STM_COUNT(ch,ns)	1+
+#define TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,cc)	TEXTWOLF_XMLSCANNER_STM_##name( TEXTWOLF_XMLSCANNER_STM_COL##cc) (int)(other_)
+#define TEXTWOLF_XMLSCANNER_STM_ROW(name,other_,fallback_,miss_,op_,arg_)\
+			{{\
+				TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,0), TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,1),\
+				TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,2), TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,3),\
+				TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,4), TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,5),\
+				TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,6), TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,7),\
+				TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,8), TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,9),\
+				TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,10), TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,11),\
+				TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,12), TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,13),\
+				TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,14), TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,15),\
+				TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,16), TEXTWOLF_XMLSCANNER_STM_NEXT(name,other_,17)\
+			}, (int)(fallback_), (int)(miss_), (int)(op_), (int)(arg_),\
+			((int)(other_) != NS)?(int)NofControlCharacter:(TEXTWOLF_XMLSCANNER_STM_##name( TEXTWOLF_XMLSCANNER_STM_COUNT) 0)},
+		static const StateTableElement tab[ NofSTMStates] =
+		{
+			TEXTWOLF_XMLSCANNER_STATES( TEXTWOLF_XMLSCANNER_STM_ROW)
+		};
+#undef TEXTWOLF_XMLSCANNER_STM_ROW
+#undef TEXTWOLF_XMLSCANNER_STM_NEXT
+#undef TEXTWOLF_XMLSCANNER_STM_COUNT
+#undef TEXTWOLF_XMLSCANNER_STM_COL0
+#undef TEXTWOLF_XMLSCANNER_STM_COL1
+#undef TEXTWOLF_XMLSCANNER_STM_COL2
+#undef TEXTWOLF_XMLSCANNER_STM_COL3
+#undef TEXTWOLF_XMLSCANNER_STM_COL4
+#undef TEXTWOLF_XMLSCANNER_STM_COL5
+#undef TEXTWOLF_XMLSCANNER_STM_COL6
+#undef TEXTWOLF_XMLSCANNER_STM_COL7
+#undef TEXTWOLF_XMLSCANNER_STM_COL8
+#undef TEXTWOLF_XMLSCANNER_STM_COL9
+#undef TEXTWOLF_XMLSCANNER_STM_COL10
+#undef TEXTWOLF_XMLSCANNER_STM_COL11
+#undef TEXTWOLF_XMLSCANNER_STM_COL12
+#undef TEXTWOLF_XMLSCANNER_STM_COL13
+#undef TEXTWOLF_XMLSCANNER_STM_COL14
+#undef TEXTWOLF_XMLSCANNER_STM_COL15
+#undef TEXTWOLF_XMLSCANNER_STM_COL16
+#undef TEXTWOLF_XMLSCANNER_STM_COL17
+		return tab;
+	}
+
 	/// \typedef IsTokenCharMap
 	/// \brief Forms a set of characters by assigning (true/false) to the whole domain
 	typedef CharMap<bool,false,NofControlCharacter> IsTokenCharMap;
@@ -412,6 +568,85 @@ public:
 			(*this)(Dq,false)(Space,true);
 		}
 	};
+
+	/// \class EventBatch
+	/// \brief Batch of XML elements scanned with one call of XMLScanner::nextItems(EventBatch&,std::size_t,unsigned short)
+	/// \remark Struct of arrays: element types, token positions, content offsets and sizes are stored in arrays of their own. The contents are copied null terminated into one contiguous arena. The memory allocated is kept when the batch is cleared, so that a batch reused does not allocate anymore after some rounds.
+	class EventBatch
+	{
+	public:
+		/// \brief Constructor
+		/// \param [in] capacity number of elements to reserve memory for
+		explicit EventBatch( std::size_t capacity=256)
+		{
+			m_types.reserve( capacity);
+			m_positions.reserve( capacity);
+			m_offsets.reserve( capacity);
+			m_sizes.reserve( capacity);
+			m_arena.reserve( capacity * 16);
+		}
+
+		/// \brief Remove all elements (keeps the memory allocated)
+		void clear()
+		{
+			m_types.clear();
+			m_positions.clear();
+			m_offsets.clear();
+			m_sizes.clear();
+			m_arena.clear();
+		}
+
+		/// \brief Append an element
+		/// \param [in] type type of the element
+		/// \param [in] position position of the element token in the source
+		/// \param [in] content pointer to the content of the element
+		/// \param [in] size size of the content of the element in bytes
+		void push( ElementType type, std::size_t position, const char* content, std::size_t size)
+		{
+			m_types.push_back( type);
+			m_positions.push_back( position);
+			m_offsets.push_back( m_arena.size());
+			m_sizes.push_back( size);
+			m_arena.append( content, size);
+			m_arena.push_back( '\0');
+		}
+
+		/// \brief Get the number of elements in the batch
+		std::size_t size() const				{return m_types.size();}
+		/// \brief Check if the batch is empty
+		bool empty() const					{return m_types.empty();}
+
+		/// \brief Get the type of an element
+		/// \param [in] idx index of the element
+		ElementType type( std::size_t idx) const		{return m_types[ idx];}
+		/// \brief Get the position of the token of an element in the source
+		/// \param [in] idx index of the element
+		std::size_t position( std::size_t idx) const		{return m_positions[ idx];}
+		/// \brief Get the content of an element as null terminated string
+		/// \param [in] idx index of the element
+		const char* content( std::size_t idx) const		{return m_arena.c_str() + m_offsets[ idx];}
+		/// \brief Get the size of the content of an element in bytes
+		/// \param [in] idx index of the element
+		std::size_t contentSize( std::size_t idx) const		{return m_sizes[ idx];}
+
+		/// \brief Get the array of the element types
+		const std::vector<ElementType>& types() const		{return m_types;}
+		/// \brief Get the array of the positions of the element tokens in the source
+		const std::vector<std::size_t>& positions() const	{return m_positions;}
+		/// \brief Get the array of the offsets of the element contents in the arena
+		const std::vector<std::size_t>& offsets() const		{return m_offsets;}
+		/// \brief Get the array of the sizes of the element contents in bytes
+		const std::vector<std::size_t>& sizes() const		{return m_sizes;}
+		/// \brief Get the arena with the null terminated contents of all elements
+		const std::string& arena() const			{return m_arena;}
+
+	private:
+		std::vector<ElementType> m_types;	///< element types
+		std::vector<std::size_t> m_positions;	///< positions of the element tokens in the source
+		std::vector<std::size_t> m_offsets;	///< offsets of the element contents in the arena
+		std::vector<std::size_t> m_sizes;	///< sizes of the element contents in bytes
+		std::string m_arena;			///< contents of the elements, each one null terminated
+	};
 };
 
 
@@ -420,7 +655,7 @@ public:
 /// \tparam InputIterator input iterator with ++ and read only * returning 0 als last character of the input
 /// \tparam InputCharSet_ character set encoding of the input, read as stream of bytes
 /// \tparam OutputCharSet_ character set encoding of the output, printed as string of the item type of the character set,
-/// \tparam OutputBuffer_ buffer for output with STL back insertion sequence interface (e.g. std::string,std::vector<char>,textwolf::StaticBuffer)
+/// \tparam OutputBuffer_ buffer for output with STL back insertion sequence interface (e.g. std::string,std::vector<char>,textwolf::StaticBuffer,textwolf::ArenaBuffer)
 template
 <
 		class InputIterator,
@@ -460,7 +695,7 @@ private:
 		unsigned int pos;			///< entity buffer position (buf)
 		unsigned int base;			///< numeric entity base (10 for decimal/16 for hexadecimal)
 		EChar value;				///< parsed entity value
-		char buf[ 16];				///< parsed entity buffer
+		char buf[ 32];				///< parsed entity buffer (long enough for all HTML5 entity names)
 		UChar curchr_saved;			///< save current character parsed for the case we cannot print it (output buffer too small)
 
 		/// \brief Constructor
@@ -484,19 +719,65 @@ public:
 public:
 	typedef TextScanner<InputIterator,InputCharSet_> InputReader;
 	typedef XMLScanner<InputIterator,InputCharSet_,OutputCharSet_,OutputBuffer_> ThisXMLScanner;
-	typedef std::map<const char*,UChar> EntityMap;
+	typedef textwolf::EntityMap EntityMap;
 	typedef OutputBuffer_ OutputBuffer;
+	typedef typename InputReader::RunDefinition RunDefinition;
 
 private:
 	/// \brief Print a character to the output token buffer
 	/// \param [in] ch unicode character to print
 	void push( UChar ch)
 	{
+		if (m_viewptr) materializeView();
 		m_output.print( ch, m_outputBuf);
 	}
 
+	/// \brief Clear the output token buffer and start a new view on the source, if zero-copy is enabled and possible
+	void clearOutput()
+	{
+		m_outputBuf.clear();
+		m_viewptr = 0;
+		m_viewsize = 0;
+	}
+
+	void startView_impl( const traits::TypeCheck::YES&)
+	{
+		if (m_zeroCopy && m_src.hasStableWindow( m_output))
+		{
+			m_viewptr = m_src.windowptr();
+		}
+	}
+
+	void startView_impl( const traits::TypeCheck::NO&)
+	{}
+
+	/// \brief Start the current token as view on the source (zero-copy), if enabled and possible
+	void startView()
+	{
+		startView_impl( traits::TypeCheck::is_same<InputCharSet,OutputCharSet>::type());
+	}
+
+	/// \brief Copy the current view on the source to the output token buffer because the token content differs from its source
+	void materializeView()
+	{
+		appendBytes( m_outputBuf, m_viewptr, m_viewsize);
+		m_viewptr = 0;
+		m_viewsize = 0;
+	}
+
 	void copychar_impl( const traits::TypeCheck::YES&)
 	{
+		if (m_viewptr)
+		{
+			std::size_t chrsize;
+			const char* chrptr = m_src.charptr( chrsize);
+			if (chrptr == m_viewptr + m_viewsize)
+			{
+				m_viewsize += chrsize;
+				return;
+			}
+			materializeView();
+		}
 		m_src.copychar( m_output, m_outputBuf);
 	}
 
@@ -510,6 +791,39 @@ private:
 		copychar_impl( traits::TypeCheck::is_same<InputCharSet,OutputCharSet>::type());
 	}
 
+	void copyrun_impl( const RunDefinition& run, const traits::TypeCheck::YES&)
+	{
+		if (m_viewptr)
+		{
+			std::size_t runsize;
+			if (m_src.skiprun( run, runsize)) m_viewsize += runsize;
+		}
+		else
+		{
+			m_src.copyrun( run, m_output, m_outputBuf);
+		}
+	}
+
+	void copyrun_impl( const RunDefinition& run, const traits::TypeCheck::NO&)
+	{
+		m_src.transcoderun( run, m_output, m_outputBuf);
+	}
+
+	/// \brief Copy a run of token characters without special meaning in one go to the output token buffer (transcoded, if input and output encoding differ)
+	/// \param [in] run definition of the characters of the run
+	void copyrun( const RunDefinition& run)
+	{
+		copyrun_impl( run, traits::TypeCheck::is_same<InputCharSet,OutputCharSet>::type());
+	}
+
+	/// \brief Get the definition of the characters of a token that can be copied in one go
+	/// \param [in] isTok set of valid token characters
+	/// \return the run definition (token characters without the carriage return that needs end of line mapping)
+	static RunDefinition getRunDefinition( const IsTokenCharMap& isTok)
+	{
+		return RunDefinition( isTok).exclude( '\r');
+	}
+
 	/// \brief Map a hexadecimal digit to its value
 	/// \param [in] ch hexadecimal digit to map to its decimal value
 	static unsigned char HEX( unsigned char ch)
@@ -726,14 +1040,16 @@ private:
 
 	/// \brief Parse a token defined by the set of valid token characters
 	/// \param [in] isTok set of valid token characters
+	/// \param [in] run definition of the token characters that can be copied in one go (derived from isTok)
 	/// \return true on success
-	bool parseToken( const IsTokenCharMap& isTok)
+	bool parseToken( const IsTokenCharMap& isTok, const RunDefinition& run)
 	{
 		if (tokstate.id == TokState::Start)
 		{
 			m_tokenpos = m_src.getPosition();
 			tokstate.id = TokState::ParsingToken;
-			m_outputBuf.clear();
+			clearOutput();
+			startView();
 		}
 		else if (tokstate.id != TokState::ParsingToken)
 		{
@@ -745,12 +1061,15 @@ private:
 		}
 		for (;;)
 		{
-			/// \todo When source and dest encoding are equal, then do not decode
-			///	the value in parsing and encode it when printing. Use some sort
-			///	of enable_if do redirect to a simple buffer copy.
-			ControlCharacter ch;
-			while (isTok[ (unsigned char)(ch=m_src.control())])
+			ControlCharacter ch = Undef;
+			while (!m_src.needMore() && isTok[ (unsigned char)(ch=m_src.control())])
 			{
+				if (ch == Undef && m_src.invalid())
+				{
+					error = ErrInvalidCharacter;
+					tokstate.init();
+					return false;
+				}
 				unsigned char aa = m_src.ascii();
 				if (aa <= 0xD)
 				{
@@ -764,7 +1083,7 @@ private:
 					{
 						if (tokstate.eolnState != TokState::CR)
 						{
-							push( (unsigned char)'\n');
+							copychar();
 						}
 						tokstate.eolnState = TokState::SRC;
 					}
@@ -780,6 +1099,15 @@ private:
 					tokstate.eolnState = TokState::SRC;
 				}
 				m_src.skip();
+				if (tokstate.eolnState == TokState::SRC)
+				{
+					copyrun( run);
+				}
+			}
+			if (m_src.needMore())
+			{
+				//... end of a chunk fed, the token is continued with the next chunk
+				return true;
 			}
 			if (ch == Amp)
 			{
@@ -837,18 +1165,21 @@ public:
 private:
 	/// \brief Skip a token defined by the set of valid token characters (same as parseToken but nothing written to the output buffer)
 	/// \param [in] isTok set of valid token characters
+	/// \param [in] run definition of the token characters that can be skipped in one go (derived from isTok)
 	/// \return true on success
-	bool skipToken( const IsTokenCharMap& isTok)
+	bool skipToken( const IsTokenCharMap& isTok, const RunDefinition& run)
 	{
 		do
 		{
 			ControlCharacter ch;
-			while (isTok[ (unsigned char)(ch=m_src.control())] || ch == Amp)
+			while (!m_src.needMore() && (isTok[ (unsigned char)(ch=m_src.control())] || ch == Amp))
 			{
 				m_src.skip();
+				std::size_t runsize;
+				m_src.skiprun( run, runsize);
 			}
 		}
-		while (m_src.control() == Any);
+		while (!m_src.needMore() && m_src.control() == Any);
 		return true;
 	}
 
@@ -950,16 +1281,16 @@ private:
 		}
 		else if (m_entityMap)
 		{
-			EntityMap::const_iterator itr = m_entityMap->find( str);
-			if (itr == m_entityMap->end())
+			const UChar* chrs;
+			std::size_t nofChrs;
+			if (!m_entityMap->find( str, chrs, nofChrs))
 			{
 				error = ErrUndefinedCharacterEntity;
 				return false;
 			}
 			else
 			{
-				UChar ch = itr->second;
-				push( ch);
+				for (std::size_t ii=0; ii<nofChrs; ++ii) push( chrs[ ii]);
 				return true;
 			}
 		}
@@ -971,47 +1302,81 @@ private:
 	}
 
 private:
+	/// \enum SkipMode
+	/// \brief States of the skip of a subtree (see skipSubtree()), named after what is parsed
+	enum SkipMode
+	{
+		SkipNone,		///< no skip in progress
+		SkipContent,		///< content
+		SkipLt,			///< after '<'
+		SkipOpenTag,		///< open tag
+		SkipSlash,		///< after '/' in an open tag
+		SkipSq,			///< single quoted attribute value
+		SkipDq,			///< double quoted attribute value
+		SkipCloseTag,		///< close tag
+		SkipExclam,		///< after '<!'
+		SkipComStart,		///< after '<!-'
+		SkipComment,		///< comment
+		SkipComDash1,		///< after '-' in a comment
+		SkipComDash2,		///< after '--' in a comment
+		SkipCdata,		///< CDATA section
+		SkipCdataB1,		///< after ']' in a CDATA section
+		SkipCdataB2,		///< after ']]' in a CDATA section
+		SkipPI,			///< processing instruction
+		SkipPIQuestm,		///< after '?' in a processing instruction
+		SkipDecl,		///< rest of a markup declaration or close tag up to '>'
+		NofSkipModes
+	};
+	struct TokenDefs;
+
 	STMState state;			///< current state of the XML scanner
 	Error error;			///< last error code
 	InputReader m_src;		///< source input iterator
 	const EntityMap* m_entityMap;	///< map with entities defined by the caller
-	OutputBuffer m_outputBuf;	///< buffer to use for output
+	mutable OutputBuffer m_outputBuf;	///< buffer to use for output
 	OutputCharSet m_output;		///< output character set
 	std::size_t m_tokenpos;		///< last token position
+	bool m_zeroCopy;		///< true, if tokens are returned as views on the source if possible (see setZeroCopy(bool))
+	mutable const char* m_viewptr;	///< start of the current token in the source, if it is returned as view on the source (zero-copy)
+	mutable std::size_t m_viewsize;	///< size of the current token in the source, if it is returned as view on the source (zero-copy)
+	SkipMode m_skipMode;		///< state of the skip of a subtree in progress (see skipSubtree()) or SkipNone
+	std::size_t m_skipDepth;	///< number of elements open in the subtree skipped
+	const SymbolTable* m_symbolTable;	///< table to resolve the elements scanned to symbols (see getItemSymbol()) or NULL
+	const TokenDefs* m_tokenDefs;	///< token character definitions (see getTokenDefs())
 
 public:
 	/// \brief Constructor
 	/// \param [in] p_src source iterator
 	/// \param [in] p_entityMap read only map of named entities defined by the user
 	XMLScanner( const InputIterator& p_src, const EntityMap& p_entityMap)
-			:state(START),error(Ok),m_src(InputCharSet(),p_src),m_entityMap(&p_entityMap),m_output(OutputCharSet()),m_tokenpos(0)
+			:state(START),error(Ok),m_src(InputCharSet(),p_src),m_entityMap(&p_entityMap),m_output(OutputCharSet()),m_tokenpos(0),m_zeroCopy(false),m_viewptr(0),m_viewsize(0),m_skipMode(SkipNone),m_skipDepth(0),m_symbolTable(0),m_tokenDefs(getTokenDefs())
 	{}
 	/// \brief Constructor
 	/// \param [in] p_src source iterator
 	explicit XMLScanner( const InputIterator& p_src)
-			:state(START),error(Ok),m_src(InputCharSet(),p_src),m_entityMap(0),m_output(OutputCharSet()),m_tokenpos(0)
+			:state(START),error(Ok),m_src(InputCharSet(),p_src),m_entityMap(0),m_output(OutputCharSet()),m_tokenpos(0),m_zeroCopy(false),m_viewptr(0),m_viewsize(0),m_skipMode(SkipNone),m_skipDepth(0),m_symbolTable(0),m_tokenDefs(getTokenDefs())
 	{}
 	/// \brief Constructor
 	/// \param [in] p_charset character set encoding of input in case of non default settings (code page) needed
 	/// \param [in] p_src source iterator
 	/// \param [in] p_entityMap read only map of named entities defined by the user
 	XMLScanner( const InputCharSet& p_charset, const InputIterator& p_src, const EntityMap& p_entityMap)
-			:state(START),error(Ok),m_src(p_charset,p_src),m_entityMap(&p_entityMap),m_output(OutputCharSet()),m_tokenpos(0)
+			:state(START),error(Ok),m_src(p_charset,p_src),m_entityMap(&p_entityMap),m_output(OutputCharSet()),m_tokenpos(0),m_zeroCopy(false),m_viewptr(0),m_viewsize(0),m_skipMode(SkipNone),m_skipDepth(0),m_symbolTable(0),m_tokenDefs(getTokenDefs())
 	{}
 	/// \brief Constructor
 	/// \param [in] p_charset character set encoding of input in case of non default settings (code page) needed
 	/// \param [in] p_src source iterator
 	XMLScanner( const InputCharSet& p_charset, const InputIterator& p_src)
-			:state(START),error(Ok),m_src(p_charset,p_src),m_entityMap(0),m_output(OutputCharSet()),m_tokenpos(0)
+			:state(START),error(Ok),m_src(p_charset,p_src),m_entityMap(0),m_output(OutputCharSet()),m_tokenpos(0),m_zeroCopy(false),m_viewptr(0),m_viewsize(0),m_skipMode(SkipNone),m_skipDepth(0),m_symbolTable(0),m_tokenDefs(getTokenDefs())
 	{}
 	/// \brief Constructor
 	/// \param [in] p_charset character set encoding of input in case of non default settings (code page) needed
 	explicit XMLScanner( const InputCharSet& p_charset)
-			:state(START),error(Ok),m_src(p_charset),m_entityMap(0),m_tokenpos(0)
+			:state(START),error(Ok),m_src(p_charset),m_entityMap(0),m_tokenpos(0),m_zeroCopy(false),m_viewptr(0),m_viewsize(0),m_skipMode(SkipNone),m_skipDepth(0),m_symbolTable(0),m_tokenDefs(getTokenDefs())
 	{}
 	/// \brief Default constructor
 	XMLScanner()
-			:state(START),error(Ok),m_src(InputCharSet()),m_entityMap(0),m_tokenpos(0)
+			:state(START),error(Ok),m_src(InputCharSet()),m_entityMap(0),m_tokenpos(0),m_zeroCopy(false),m_viewptr(0),m_viewsize(0),m_skipMode(SkipNone),m_skipDepth(0),m_symbolTable(0),m_tokenDefs(getTokenDefs())
 	{}
 
 	/// \brief Copy constructor
@@ -1023,6 +1388,13 @@ public:
 		,m_entityMap(o.m_entityMap)
 		,m_outputBuf(o.m_outputBuf)
 		,m_tokenpos(o.m_tokenpos)
+		,m_zeroCopy(o.m_zeroCopy)
+		,m_viewptr(o.m_viewptr)
+		,m_viewsize(o.m_viewsize)
+		,m_skipMode(o.m_skipMode)
+		,m_skipDepth(o.m_skipDepth)
+		,m_symbolTable(o.m_symbolTable)
+		,m_tokenDefs(o.m_tokenDefs)
 	{}
 
 	/// \brief Assign something to the source iterator while keeping the state
@@ -1047,25 +1419,87 @@ public:
 
 	/// \brief Get the current parsed XML element pointer, if it was not masked out, see nextItem(unsigned short)
 	/// \return the item string
-	const char* getItemPtr() const {return m_outputBuf.size()?&m_outputBuf.at(0):"\0\0\0\0";}
+	/// \remark If zero-copy is enabled (see setZeroCopy(bool)) the item string may point into the source and is not null terminated
+	const char* getItemPtr() const
+	{
+		if (m_viewptr && m_viewsize) return m_viewptr;
+		return m_outputBuf.size()?&m_outputBuf.at(0):"\0\0\0\0";
+	}
 
 	/// \brief Get the size of the current parsed XML element in bytes
 	/// \return the item string
-	std::size_t getItemSize() const {return m_outputBuf.size();}
+	std::size_t getItemSize() const
+	{
+		return m_viewptr?m_viewsize:m_outputBuf.size();
+	}
 
 	/// \brief Get the current parsed XML element, if it was not masked out, see nextItem(unsigned short)
+	/// \remark A token returned as view on the source (see setZeroCopy(bool)) is copied into the output buffer here
 	/// \return the item string
 	const OutputBuffer& getItem() const
 	{
+		if (m_viewptr)
+		{
+			appendBytes( m_outputBuf, m_viewptr, m_viewsize);
+			m_viewptr = 0;
+			m_viewsize = 0;
+		}
 		return m_outputBuf;
 	}
 
+	/// \brief Free the contents of all elements kept in the output buffer
+	/// \remark With an ArenaBuffer as output buffer, that keeps all elements scanned until it is reset, this recycles its memory, e.g. at the end of every record of a document. The current element and all views on previous elements (ArenaBuffer::StringRef) get invalid. For scanners fed chunk by chunk it has to be called after an element has been returned and not after nextItem(unsigned short) returned None, because then the output buffer may hold a token not completely scanned.
+	void resetOutput()
+	{
+		resetBuffer( m_outputBuf);
+		m_viewptr = 0;
+		m_viewsize = 0;
+	}
+
+	/// \brief Set the table of symbols the elements scanned are resolved with (see getItemSymbol())
+	/// \remark Usually the table of the XMLPathSelectAutomaton the elements are fed to (see XMLPathSelectAutomaton::symbols()). The table is not owned and has to stay valid as long as the scanner uses it. The output character set encoding of the scanner has to be the one of the symbols.
+	/// \param [in] symbolTable_ the table or NULL to resolve nothing
+	void setSymbolTable( const SymbolTable* symbolTable_)
+	{
+		m_symbolTable = symbolTable_;
+	}
+
+	/// \brief Get the identifier of the current parsed XML element in the symbol table set with setSymbolTable(const SymbolTable*)
+	/// \remark The element is resolved with one hash lookup, elements longer than any symbol are rejected without hashing. Elements masked out (see nextItem(unsigned short)) are resolved as empty string.
+	/// \return the identifier or 0, if the element is not defined in the table or no table is set
+	int getItemSymbol() const
+	{
+		return m_symbolTable ? m_symbolTable->get( getItemPtr(), getItemSize()) : 0;
+	}
+
+	/// \brief Enable or disable the return of tokens as views on the source (zero-copy)
+	/// \remark Tokens are returned as views only if the source is a contiguous block of memory that stays valid during the scan (see WindowTraits), input and output encoding are equal and byte oriented (UTF-8, IsoLatin with the same code page) and the token content does not differ from its source (no entities, no carriage returns). Otherwise they are copied into the output buffer. Views on the source are not null terminated.
+	/// \param [in] enable true, if zero-copy should be enabled
+	/// \return true, if zero-copy is available for this scanner type
+	bool setZeroCopy( bool enable=true)
+	{
+		m_zeroCopy = enable;
+		return zeroCopyAvailable( traits::TypeCheck::is_same<InputCharSet,OutputCharSet>::type());
+	}
+
+private:
+	static bool zeroCopyAvailable( const traits::TypeCheck::YES&)
+	{
+		return WindowTraits<InputIterator>::Enabled && ByteRunTraits<InputCharSet>::Enabled;
+	}
+
+	static bool zeroCopyAvailable( const traits::TypeCheck::NO&)
+	{
+		return false;
+	}
+
+public:
+
 	/// \brief Get the current XML scanner state machine state
 	/// \return pointer to the state variables
-	ScannerStatemachine::Element* getState()
+	const StateTableElement* getState() const
 	{
-		static Statemachine stm;
-		return stm.get( state);
+		return stateTable() + state;
 	}
 
 	/// \brief Get the last error
@@ -1091,47 +1525,313 @@ public:
 		return m_src.getIterator();
 	}
 
+	/// \brief Feed the next chunk of input to a scanner on a SrcIterator (push API)
+	/// \remark The chunk has to stay valid until nextItem(unsigned short) returns None (need more input) or the end of the document. Elements returned are copied to the output buffer except for tokens in the last chunk if zero-copy is enabled (see setZeroCopy(bool)).
+	/// \param [in] chunk pointer to the chunk of input
+	/// \param [in] chunksize size of the chunk in bytes
+	/// \param [in] eof true, if the chunk contains the rest of the input
+	void feed( const char* chunk, std::size_t chunksize, bool eof=false)
+	{
+		m_src.getIterator().putInput( chunk, chunksize, eof?SrcIterator::LastChunk:SrcIterator::PartialChunk);
+	}
+
 	/// \brief Scan the next XML element
+	/// \remark For scanners fed chunk by chunk (see feed(const char*,std::size_t,bool)) the state is saved at the end of a chunk and the next call continues exactly where the scanner stopped. The end of a chunk is checked before reading the next character (see SrcIterator::needMore()), only if it splits an entity reference, a keyword or a multibyte character, it is caught as SrcIterator::EndOfChunk exception.
 	/// \param [in] mask element types that should be printed to the output buffer (1 -> print, 0 -> mask out, just return the element as event)
-	/// \return the type of the XML element
+	/// \return the type of the XML element or None if the end of a chunk fed was reached and more input is needed
 	ElementType nextItem( unsigned short mask=0xFFFF)
 	{
-		static const IsWordCharMap wordC;
-		static const IsContentCharMap contentC;
-		static const IsTagCharMap tagC;
-		static const IsSQStringCharMap sqC;
-		static const IsDQStringCharMap dqC;
-		static const IsTokenCharMap* tokenDefs[ NofSTMActions] = {0,&wordC,&contentC,&tagC,&sqC,&dqC,0,0,0};
+		try
+		{
+			return scanItem( mask);
+		}
+		catch (const SrcIterator::EndOfChunk&)
+		{
+			return None;
+		}
+	}
+
+	/// \brief Scan a batch of XML elements
+	/// \remark Stops after maxCount elements or after an element of type Exit, ErrorOccurred or None (end of a chunk fed, more input needed, see feed(const char*,std::size_t,bool)), that is then the last element of the batch
+	/// \param [out] batch where to write the elements scanned to (cleared first)
+	/// \param [in] maxCount maximum number of elements to scan
+	/// \param [in] mask element types that should be printed to the output buffer (1 -> print, 0 -> mask out, just return the element as event with empty content)
+	/// \return the number of elements in the batch
+	std::size_t nextItems( EventBatch& batch, std::size_t maxCount, unsigned short mask=0xFFFF)
+	{
+		batch.clear();
+		try
+		{
+			while (batch.size() < maxCount)
+			{
+				ElementType et = scanItem( mask);
+				if (et == None)
+				{
+					batch.push( None, m_tokenpos, "", 0);
+					break;
+				}
+				if ((mask & (1 << et)) != 0)
+				{
+					batch.push( et, m_tokenpos, getItemPtr(), getItemSize());
+				}
+				else
+				{
+					batch.push( et, m_tokenpos, "", 0);
+				}
+				if (et == Exit || et == ErrorOccurred) break;
+			}
+		}
+		catch (const SrcIterator::EndOfChunk&)
+		{
+			batch.push( None, m_tokenpos, "", 0);
+		}
+		return batch.size();
+	}
+
+	/// \brief Skip the rest of the current element with its subtree without returning any elements of it
+	/// \remark The current element is the one of the last open tag that has not been closed yet, usually skipSubtree() is called after nextItem(unsigned short) returned an OpenTag or one of its attributes. The markup is not validated and entities are not resolved in the skipped part, only comments, CDATA sections, processing instructions and quoted attribute values are recognized, so that no '<' or '>' inside them is taken as tag delimiter. For sources on contiguous memory and byte oriented character set encodings, the search for the next significant character is vectorized (see ByteSet).
+	/// \return CloseTag with empty content for the end of the element skipped, ErrorOccurred on error or None if the end of a chunk fed was reached (see feed(const char*,std::size_t,bool)), then the skip is continued by the next call of nextItem(unsigned short) or skipSubtree() after feeding more input
+	ElementType skipSubtree()
+	{
+		// ... a skip interrupted by the end of a chunk is continued and not started again
+		if (m_skipMode != SkipNone) return nextItem();
+		switch (state)
+		{
+			case OPENTAG: case TAGAISK: case TAGANAM: case TAGAESK: case TAGAVSK: case TAGAVID: case TAGAVQE:
+				m_skipMode = SkipOpenTag; m_skipDepth = 0; break;
+			case TAGAVSQ:
+				m_skipMode = SkipSq; m_skipDepth = 0; break;
+			case TAGAVDQ:
+				m_skipMode = SkipDq; m_skipDepth = 0; break;
+			case TAGCLIM:
+				m_skipMode = SkipSlash; m_skipDepth = 0; break;
+			case CONTENT: case TOKEN: case SEEKTOK:
+				m_skipMode = SkipContent; m_skipDepth = 1; break;
+			case XMLTAG:
+				m_skipMode = SkipLt; m_skipDepth = 1; break;
+			case TAGCLSK:
+				m_skipMode = SkipDecl; m_skipDepth = 1; break;
+			default:
+				error = ErrNoElementToSkip;
+				return ErrorOccurred;
+		}
+		return nextItem();
+	}
+
+private:
+	/// \class SkipDefs
+	/// \brief Sets of characters that have to be inspected in a skip mode, all others are skipped in one go (see TextScanner::skipbytes(const ByteSet&))
+	struct SkipDefs
+	{
+		ByteSet stop[ NofSkipModes];	///< characters to stop at by skip mode
+		bool bulk[ NofSkipModes];	///< true, if characters not in stop[] are skipped in one go
+
+		SkipDefs()
+		{
+			static const char* stopchars[ NofSkipModes] = {0,"<",0,">\"'/",0,"'","\"",">",0,0,"-",0,0,"]",0,0,"?",0,">"};
+			for (unsigned int ii=0; ii<NofSkipModes; ++ii)
+			{
+				bulk[ ii] = (stopchars[ ii] != 0);
+				stop[ ii]( 0);
+				for (const char* cc = stopchars[ ii]; cc && *cc; ++cc) stop[ ii]( (unsigned char)*cc);
+			}
+		}
+	};
+
+	/// \brief Continue the skip of a subtree started with skipSubtree()
+	/// \return CloseTag at the end of the subtree or ErrorOccurred
+	ElementType skipMarkup()
+	{
+		static const SkipDefs skipDefs;
+		for (;;)
+		{
+			if (skipDefs.bulk[ m_skipMode]) m_src.skipbytes( skipDefs.stop[ m_skipMode]);
+			if (m_src.needMore()) return None;
+			if (m_src.control() == EndOfText)
+			{
+				m_skipMode = SkipNone;
+				error = ErrUnexpectedEndOfText;
+				return ErrorOccurred;
+			}
+			unsigned char ch = m_src.ascii();
+			switch (m_skipMode)
+			{
+				case SkipNone:
+					break;
+				case SkipContent:
+					if (ch == '<')
+					{
+						m_tokenpos = m_src.getPosition();
+						m_skipMode = SkipLt;
+					}
+					break;
+				case SkipLt:
+					m_skipMode = (ch == '/')?SkipCloseTag:(ch == '!')?SkipExclam:(ch == '?')?SkipPI:SkipOpenTag;
+					break;
+				case SkipSlash:
+					if (ch == '>')
+					{
+						if (m_skipDepth == 0) return skipDone();
+						m_skipMode = SkipContent;
+						break;
+					}
+					if (ch <= 32) break;
+					m_skipMode = SkipOpenTag;
+					/*no break here!*/
+				case SkipOpenTag:
+					if (ch == '>')
+					{
+						++m_skipDepth;
+						m_skipMode = SkipContent;
+					}
+					else if (ch == '/') m_skipMode = SkipSlash;
+					else if (ch == '\'') m_skipMode = SkipSq;
+					else if (ch == '\"') m_skipMode = SkipDq;
+					break;
+				case SkipSq:
+					if (ch == '\'') m_skipMode = SkipOpenTag;
+					break;
+				case SkipDq:
+					if (ch == '\"') m_skipMode = SkipOpenTag;
+					break;
+				case SkipCloseTag:
+					if (ch == '>')
+					{
+						if (--m_skipDepth == 0) return skipDone();
+						m_skipMode = SkipContent;
+					}
+					break;
+				case SkipExclam:
+					m_skipMode = (ch == '-')?SkipComStart:(ch == '[')?SkipCdata:(ch == '>')?SkipContent:SkipDecl;
+					break;
+				case SkipComStart:
+					m_skipMode = (ch == '-')?SkipComment:(ch == '>')?SkipContent:SkipDecl;
+					break;
+				case SkipComment:
+					if (ch == '-') m_skipMode = SkipComDash1;
+					break;
+				case SkipComDash1:
+					m_skipMode = (ch == '-')?SkipComDash2:SkipComment;
+					break;
+				case SkipComDash2:
+					m_skipMode = (ch == '>')?SkipContent:(ch == '-')?SkipComDash2:SkipComment;
+					break;
+				case SkipCdata:
+					if (ch == ']') m_skipMode = SkipCdataB1;
+					break;
+				case SkipCdataB1:
+					m_skipMode = (ch == ']')?SkipCdataB2:SkipCdata;
+					break;
+				case SkipCdataB2:
+					m_skipMode = (ch == '>')?SkipContent:(ch == ']')?SkipCdataB2:SkipCdata;
+					break;
+				case SkipPI:
+					if (ch == '?') m_skipMode = SkipPIQuestm;
+					break;
+				case SkipPIQuestm:
+					m_skipMode = (ch == '>')?SkipContent:(ch == '?')?SkipPIQuestm:SkipPI;
+					break;
+				case SkipDecl:
+					if (ch == '>') m_skipMode = SkipContent;
+					break;
+				case NofSkipModes:
+					break;
+			}
+			m_src.skip();
+		}
+	}
+
+	/// \brief Finish the skip of a subtree at the '>' closing it
+	ElementType skipDone()
+	{
+		m_src.skip();
+		m_skipMode = SkipNone;
+		state = CONTENT;
+		clearOutput();
+		return CloseTag;
+	}
+
+	/// \class TokenDefs
+	/// \brief Definitions of the token characters of the state machine actions returning a token
+	struct TokenDefs
+	{
+		IsWordCharMap wordC;
+		IsContentCharMap contentC;
+		IsTagCharMap tagC;
+		IsSQStringCharMap sqC;
+		IsDQStringCharMap dqC;
+		RunDefinition wordR;
+		RunDefinition contentR;
+		RunDefinition tagR;
+		RunDefinition sqR;
+		RunDefinition dqR;
+		const IsTokenCharMap* isTok[ NofSTMActions];	///< token characters by action (STMAction)
+		const RunDefinition* run[ NofSTMActions];	///< token characters copied in one go by action (STMAction)
+
+		TokenDefs()
+			:wordR(getRunDefinition( wordC))
+			,contentR(getRunDefinition( contentC))
+			,tagR(getRunDefinition( tagC))
+			,sqR(getRunDefinition( sqC))
+			,dqR(getRunDefinition( dqC))
+		{
+			const IsTokenCharMap* isTok_[ NofSTMActions] = {0,&wordC,&contentC,&tagC,&sqC,&dqC,0,0,0};
+			const RunDefinition* run_[ NofSTMActions] = {0,&wordR,&contentR,&tagR,&sqR,&dqR,0,0,0};
+			for (unsigned int ii=0; ii<NofSTMActions; ++ii)
+			{
+				isTok[ ii] = isTok_[ ii];
+				run[ ii] = run_[ ii];
+			}
+		}
+	};
+
+	/// \brief Get the token character definitions shared by all scanners
+	/// \remark Called by the constructors, so that the static initialization check is done once per scanner and not per call of nextItem
+	static const TokenDefs* getTokenDefs()
+	{
+		static const TokenDefs rt;
+		return &rt;
+	}
+
+	/// \brief Scan the next XML element (see nextItem(unsigned short))
+	ElementType scanItem( unsigned short mask)
+	{
+		if (m_skipMode != SkipNone) return skipMarkup();
+
+		const TokenDefs& tokenDefs = *m_tokenDefs;
 		static const char* stringDefs[ NofSTMActions] = {0,0,0,0,0,0,"xml","CDATA",0};
+		const StateTableElement* stm = stateTable();
 
 		ElementType rt = None;
 		ControlCharacter ch;
 		do
 		{
-			ScannerStatemachine::Element* sd = getState();
-			if (sd->action.op != -1)
+			const StateTableElement* sd = stm + state;
+			if (sd->actionOp != -1)
 			{
-				if (tokenDefs[sd->action.op])
+				if (tokenDefs.isTok[ sd->actionOp])
 				{
 					if (tokstate.id != TokState::ParsingDone)
 					{
-						if ((mask&(1<<sd->action.arg)) != 0)
+						if ((mask&(1<<sd->actionArg)) != 0)
 						{
-							if (!parseToken( *tokenDefs[ sd->action.op])) return ErrorOccurred;
+							if (!parseToken( *tokenDefs.isTok[ sd->actionOp], *tokenDefs.run[ sd->actionOp])) return ErrorOccurred;
 						}
 						else
 						{
-							if (!skipToken( *tokenDefs[ sd->action.op])) return ErrorOccurred;
+							clearOutput();
+							if (!skipToken( *tokenDefs.isTok[ sd->actionOp], *tokenDefs.run[ sd->actionOp])) return ErrorOccurred;
 						}
+						if (m_src.needMore()) return None;
 					}
-					rt = (ElementType)sd->action.arg;
+					rt = (ElementType)sd->actionArg;
 				}
-				else if (stringDefs[sd->action.op])
+				else if (stringDefs[sd->actionOp])
 				{
 					if (tokstate.id != TokState::ParsingDone)
 					{
-						if (!expectStr( stringDefs[sd->action.op])) return ErrorOccurred;
-						if (sd->action.op == ExpectIdentifierXML)
+						if (!expectStr( stringDefs[sd->actionOp])) return ErrorOccurred;
+						if (sd->actionOp == ExpectIdentifierXML)
 						{
 							//... special treatement for xml header for not
 							//    enforcing the model too much just for this case
@@ -1139,7 +1839,7 @@ public:
 							rt = HeaderStart;
 						}
 					}
-					else if (sd->action.op == ExpectIdentifierXML)
+					else if (sd->actionOp == ExpectIdentifierXML)
 					{
 						//... special treatement for xml header for not
 						//    enforcing the model too much just for this case
@@ -1149,8 +1849,8 @@ public:
 				else
 				{
 					m_tokenpos = m_src.getPosition();
-					m_outputBuf.clear();
-					rt = (ElementType)sd->action.arg;
+					clearOutput();
+					rt = (ElementType)sd->actionArg;
 				}
 				if (sd->nofnext == 0)
 				{
@@ -1161,6 +1861,7 @@ public:
 					return rt;
 				}
 			}
+			if (m_src.needMore()) return None;
 			ch = m_src.control();
 			tokstate.id = TokState::Start;
 
@@ -1193,6 +1894,7 @@ public:
 		return rt;
 	}
 
+public:
 	/// \class End
 	/// \brief end of input tag
 	struct End {};
@@ -0,0 +1,143 @@
+#include "textwolf.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+//build gcc
+//compile: g++ -c -o test_ArenaBuffer.o -g -I../include/ -pedantic -Wall -O4 test_ArenaBuffer.cpp
+//link: g++ -lc -o test_ArenaBuffer test_ArenaBuffer.o
+//build windows
+//compile: cl.exe /wd4996 /Ob2 /O2 /EHsc /MT /W4 /nologo /I..\include /D "WIN32" /D "_WINDOWS" /Fo"test_ArenaBuffer.obj" test_ArenaBuffer.cpp
+//link: link.exe /out:.\test_ArenaBuffer test_ArenaBuffer.obj
+
+using namespace textwolf;
+
+/// \brief Scan a document and return all elements as copies
+static std::vector<std::string> scanCopies( const std::string& doc)
+{
+	typedef XMLScanner<SrcIterator,charset::UTF8,charset::UTF8,std::string> Scanner;
+	std::vector<std::string> rt;
+	Scanner xs( SrcIterator( doc.c_str(), doc.size()));
+	for (;;)
+	{
+		Scanner::ElementType type = xs.nextItem();
+		rt.push_back( std::string( xs.getItemPtr(), xs.getItemSize()));
+		if (type == Scanner::ErrorOccurred || type == Scanner::Exit) break;
+	}
+	return rt;
+}
+
+static bool check( const char* what, bool cond)
+{
+	if (!cond) std::cerr << "FAILED " << what << std::endl;
+	return cond;
+}
+
+/// \brief Scan a document into an arena keeping all elements as views on it and compare them with the expected elements at the end
+/// \remark With zero-copy enabled, the elements returned as views on the source are copied into the arena by XMLScanner::getItem()
+static bool scanArena( const std::string& doc, const std::vector<std::string>& expected, bool zeroCopy)
+{
+	typedef XMLScanner<SrcIterator,charset::UTF8,charset::UTF8,ArenaBuffer> Scanner;
+	std::vector<ArenaBuffer::StringRef> refs;
+	Scanner xs( SrcIterator( doc.c_str(), doc.size()));
+	xs.setZeroCopy( zeroCopy);
+	for (;;)
+	{
+		Scanner::ElementType type = xs.nextItem();
+		refs.push_back( xs.getItem().ref());
+		if (type == Scanner::ErrorOccurred || type == Scanner::Exit) break;
+	}
+	if (!check( "number of elements", refs.size() == expected.size())) return false;
+	for (std::size_t ei=0; ei<refs.size(); ++ei)
+	{
+		if (!check( "element content", refs[ ei].str() == expected[ ei])) return false;
+		if (!check( "null termination", refs[ ei].ptr()[ refs[ ei].size()] == 0)) return false;
+	}
+	return true;
+}
+
+/// \brief Scan a document into an arena that is reset at the end of every record and check that the memory allocated stays within one chunk
+static bool scanRecords( const std::string& doc, const std::vector<std::string>& expected, std::size_t chunksize)
+{
+	typedef XMLScanner<SrcIterator,charset::UTF8,charset::UTF8,ArenaBuffer> Scanner;
+	Scanner xs( SrcIterator( doc.c_str(), doc.size()));
+	std::vector<ArenaBuffer::StringRef> refs;
+	std::size_t ei = 0;
+	for (;;)
+	{
+		Scanner::ElementType type = xs.nextItem();
+		refs.push_back( xs.getItem().ref());
+		if (!check( "allocated memory", xs.getItem().allocated() <= chunksize)) return false;
+		if (type == Scanner::ErrorOccurred || type == Scanner::Exit) break;
+		if (type == Scanner::CloseTag && refs.back().str() == "rec")
+		{
+			// ... the elements of the record stay valid until the reset
+			for (std::size_t ri=0; ri<refs.size(); ++ri,++ei)
+			{
+				if (!check( "record element", ei < expected.size() && refs[ ri].str() == expected[ ei])) return false;
+			}
+			refs.clear();
+			xs.resetOutput();
+		}
+	}
+	return check( "number of elements", ei + refs.size() == expected.size());
+}
+
+int main( int, const char**)
+{
+	try
+	{
+		std::string doc( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<doc>");
+		for (unsigned int ii=0; ii<300; ++ii)
+		{
+			doc.append( "<rec id='");
+			doc.append( std::string( ii % 17 + 1, (char)('a' + ii % 26)));
+			doc.append( "'>content &amp; text ");
+			doc.append( std::string( ii, 'x'));
+			doc.append( "</rec>");
+		}
+		doc.append( "</doc>");
+		std::vector<std::string> expected = scanCopies( doc);
+
+		// ... all elements stay valid in the arena until the end of the scan
+		if (!scanArena( doc, expected, false) || !scanArena( doc, expected, true)) return 1;
+
+		// ... an arena reset at the end of every record does not grow
+		if (!scanRecords( doc, expected, 16384)) return 1;
+		{
+			ArenaBuffer arena( 16);
+			std::vector<ArenaBuffer::StringRef> refs;
+			std::vector<std::string> strs;
+			for (unsigned int ii=0; ii<200; ++ii)
+			{
+				arena.clear();
+				std::string str( ii % 40, (char)('A' + ii % 26));
+				for (std::size_t ci=0; ci<str.size(); ++ci) arena.push_back( str[ ci]);
+				if (ii % 3 == 0)
+				{
+					arena.append( "tail", 4);
+					str.append( "tail");
+				}
+				refs.push_back( arena.ref());
+				strs.push_back( str);
+			}
+			for (std::size_t ri=0; ri<refs.size(); ++ri)
+			{
+				if (!check( "arena string", refs[ ri].str() == strs[ ri])) return 1;
+			}
+			std::size_t allocated = arena.allocated();
+			arena.reset();
+			if (!check( "reset", arena.size() == 0 && arena.allocated() < allocated && arena.ptr()[0] == 0)) return 1;
+			arena.append( "abc", 3);
+			ArenaBuffer copy( arena);
+			if (!check( "copy", copy.ref() == arena.ref() && copy.ptr() != arena.ptr())) return 1;
+		}
+		std::cerr << "OK" << std::endl;
+		return 0;
+	}
+	catch (const std::exception& ee)
+	{
+		std::cerr << "ERROR " << ee.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,118 @@
+#include "textwolf.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <map>
+#include <vector>
+
+//build gcc
+//compile: g++ -c -o test_EntityMap.o -g -I../include/ -pedantic -Wall -O4 test_EntityMap.cpp
+//link: g++ -lc -o test_EntityMap test_EntityMap.o
+//build windows
+//compile: cl.exe /wd4996 /Ob2 /O2 /EHsc /MT /W4 /nologo /I..\include /D "WIN32" /D "_WINDOWS" /Fo"test_EntityMap.obj" test_EntityMap.cpp
+//link: link.exe /out:.\test_EntityMap test_EntityMap.obj
+
+using namespace textwolf;
+
+static std::string entityName( unsigned int idx)
+{
+	static const char* prefix[] = {"a","al","alpha","Alpha","b","bet","beta","CounterClockwiseContourIntegral","x"};
+	std::ostringstream rt;
+	rt << prefix[ idx % 9];
+	for (idx /= 9; idx; idx /= 26) rt << (char)('a' + idx % 26);
+	return rt.str();
+}
+
+int main( int, const char**)
+{
+	try
+	{
+		enum {NofEntities=2200};
+		std::map<std::string,UChar> def;
+		for (unsigned int ii=0; ii<NofEntities; ++ii)
+		{
+			def[ entityName( ii)] = 0x100 + ii;
+		}
+		EntityMap emap( def);
+		if (emap.size() != def.size())
+		{
+			std::cerr << "FAILED size " << emap.size() << " != " << def.size() << std::endl;
+			return 1;
+		}
+		std::map<std::string,UChar>::const_iterator di = def.begin(), de = def.end();
+		for (; di != de; ++di)
+		{
+			UChar chr = 0;
+			if (!emap.find( di->first.c_str(), chr) || chr != di->second)
+			{
+				std::cerr << "FAILED find '" << di->first << "'" << std::endl;
+				return 1;
+			}
+			std::string unknown = di->first + "Q";
+			if (emap.find( unknown.c_str(), chr) && def.find( unknown) == def.end())
+			{
+				std::cerr << "FAILED found undefined '" << unknown << "'" << std::endl;
+				return 1;
+			}
+		}
+		UChar chr;
+		if (emap.find( "", chr) || emap.find( "Alph", chr) || emap.find( "CounterClockwiseContourIntegra", chr))
+		{
+			std::cerr << "FAILED found prefix of a defined entity" << std::endl;
+			return 1;
+		}
+
+		// ... one entity map shared by scanners, with a name longer than the predefined ones
+		EntityMap hmap;
+		hmap( "copy", 0xA9)( "CounterClockwiseContourIntegral", 0x2233);
+		hmap[ "euro"] = 0x20AC;
+		static const UChar notEqualTilde[] = {0x2242, 0x0338};
+		std::vector<UChar> fjlig;
+		fjlig.push_back( 'f');
+		fjlig.push_back( 'j');
+		hmap( "NotEqualTilde", notEqualTilde, 2);
+		hmap.insert( "fjlig", fjlig);
+		typedef XMLScanner<char*,charset::UTF8,charset::UTF8,std::string> MyXMLScanner;
+		const char* doc = "<doc a='&euro;&amp;&fjlig;'>&copy;&CounterClockwiseContourIntegral;&lt;&NotEqualTilde;</doc>";
+		const char* expected = "\xE2\x82\xAC&fj|\xC2\xA9\xE2\x88\xB3<\xE2\x89\x82\xCC\xB8|";
+		for (unsigned int si=0; si<2; ++si)
+		{
+			MyXMLScanner xs( const_cast<char*>( doc), hmap);
+			std::string result;
+			MyXMLScanner::iterator itr = xs.begin(), end = xs.end();
+			for (; itr != end; ++itr)
+			{
+				if (itr->type() == MyXMLScanner::ErrorOccurred)
+				{
+					std::cerr << "FAILED scanner error " << itr->content() << std::endl;
+					return 1;
+				}
+				if (itr->type() == MyXMLScanner::TagAttribValue || itr->type() == MyXMLScanner::Content)
+				{
+					result.append( itr->content(), itr->size());
+					result.push_back( '|');
+				}
+			}
+			if (result != expected)
+			{
+				std::cerr << "FAILED scanned '" << result << "'" << std::endl;
+				return 1;
+			}
+		}
+		MyXMLScanner xs( const_cast<char*>( "<doc>&undefined;</doc>"), hmap);
+		MyXMLScanner::iterator itr = xs.begin(), end = xs.end();
+		for (; itr != end && itr->type() != MyXMLScanner::ErrorOccurred; ++itr){}
+		if (itr == end)
+		{
+			std::cerr << "FAILED undefined entity not detected" << std::endl;
+			return 1;
+		}
+		std::cerr << "OK" << std::endl;
+		return 0;
+	}
+	catch (const std::exception& ee)
+	{
+		std::cerr << "ERROR " << ee.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,171 @@
+#include "textwolf.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+
+//build gcc
+//compile: g++ -c -o test_ScannerFactory.o -g -I../include/ -pedantic -Wall -O4 test_ScannerFactory.cpp
+//link: g++ -lc -o test_ScannerFactory test_ScannerFactory.o
+//build windows
+//compile: cl.exe /wd4996 /Ob2 /O2 /EHsc /MT /W4 /nologo /I..\include /D "WIN32" /D "_WINDOWS" /Fo"test_ScannerFactory.obj" test_ScannerFactory.cpp
+//link: link.exe /out:.\test_ScannerFactory test_ScannerFactory.obj
+
+using namespace textwolf;
+
+typedef ScannerFactory<charset::UTF8,std::string> Factory;
+
+/// \brief Encode a UTF-8 document in another encoding
+template <class CharSet>
+static std::string encodeDoc( const std::string& doc, const CharSet& charset)
+{
+	std::string rt;
+	TextScanner<CStringIterator,charset::UTF8> reader( CStringIterator( doc.c_str(), doc.size()));
+	for (; reader.chr(); ++reader) charset.print( reader.chr(), rt);
+	return rt;
+}
+
+/// \brief Print the elements of a scanner (handle or specialized scanner)
+template <class Scanner>
+static std::string printElements( Scanner& xs)
+{
+	std::ostringstream out;
+	for (;;)
+	{
+		XMLScannerBase::ElementType type = xs.nextItem();
+		out << XMLScannerBase::getElementTypeName( type) << " [" << std::string( xs.getItemPtr(), xs.getItemSize()) << "]" << std::endl;
+		if (type == XMLScannerBase::ErrorOccurred || type == XMLScannerBase::Exit) break;
+	}
+	return out.str();
+}
+
+/// \brief Visitor printing the elements of the scanner specialized for the encoding detected
+struct PrintVisitor
+{
+	std::string result;
+
+	template <class Scanner>
+	void operator()( Scanner& xs)
+	{
+		result = printElements( xs);
+	}
+};
+
+static const char* g_content = "<doc attr='\xC3\xA4\xC3\xB6\xC3\xBC'>text \xE2\x82\xAC &amp; more text</doc>";
+
+/// \brief Test the detection of the encoding of a document and the scanning with the scanner created by the factory
+template <class CharSet>
+static bool testEncoding( const char* name, const CharSet& charset, const std::string& bom, const char* headerEncoding, XMLEncoding::Id expectedId, unsigned int expectedCodePage=0)
+{
+	std::string utf8doc;
+	if (headerEncoding)
+	{
+		utf8doc.append( "<?xml version=\"1.0\" encoding=\"");
+		utf8doc.append( headerEncoding);
+		utf8doc.append( "\" standalone=\"yes\"?>\n");
+	}
+	utf8doc.append( g_content);
+	std::string doc = bom + encodeDoc( utf8doc, charset);
+
+	XMLEncoding encoding = XMLEncoding::detect( doc.c_str(), doc.size());
+	if (encoding.id != expectedId || encoding.codePage != expectedCodePage || encoding.bomSize != bom.size())
+	{
+		std::cerr << "test " << name << " failed: detected " << XMLEncoding::idName( encoding.id) << " code page " << encoding.codePage << " BOM size " << encoding.bomSize << std::endl;
+		return false;
+	}
+	// ... expected result with the scanner instantiated explicitely for the encoding
+	std::string expected;
+	{
+		typedef XMLScanner<SrcIterator,CharSet,charset::UTF8,std::string> Scanner;
+		Scanner xs( charset, SrcIterator( doc.c_str() + bom.size(), doc.size() - bom.size()));
+		expected = printElements( xs);
+	}
+	Factory::Scanner xs = Factory::create( doc.c_str(), doc.size());
+	std::string result = printElements( xs);
+
+	PrintVisitor visitor;
+	Factory::Scanner xs_visited = Factory::create( doc.c_str(), doc.size());
+	Factory::Scanner xs_copy( xs_visited);
+	xs_copy.visit( visitor);
+
+	// ... chunkwise feeding with the header in the first chunk
+	std::string result_chunkwise;
+	{
+		std::size_t chunksize = 64;
+		Factory::Scanner xc = Factory::create( doc.c_str(), chunksize < doc.size() ? chunksize : doc.size(), chunksize >= doc.size());
+		std::ostringstream out;
+		std::size_t pos = chunksize;
+		for (;;)
+		{
+			XMLScannerBase::ElementType type = xc.nextItem();
+			if (type == XMLScannerBase::None)
+			{
+				std::size_t nn = (pos + chunksize < doc.size()) ? chunksize : (doc.size() - pos);
+				xc.feed( doc.c_str() + pos, nn, pos + nn >= doc.size());
+				pos += nn;
+				continue;
+			}
+			out << XMLScannerBase::getElementTypeName( type) << " [" << std::string( xc.getItemPtr(), xc.getItemSize()) << "]" << std::endl;
+			if (type == XMLScannerBase::ErrorOccurred || type == XMLScannerBase::Exit) break;
+		}
+		result_chunkwise = out.str();
+	}
+	if (expected != result || expected != visitor.result || expected != result_chunkwise || expected.find( "ErrorOccurred") != std::string::npos)
+	{
+		std::cerr << "test " << name << " failed:" << std::endl << expected << std::endl << result << std::endl << visitor.result << std::endl << result_chunkwise << std::endl;
+		return false;
+	}
+	return true;
+}
+
+int main( int, const char**)
+{
+	try
+	{
+		const std::string bom_utf8( "\xEF\xBB\xBF");
+		const std::string bom_le16( "\xFF\xFE");
+		const std::string bom_be16( "\xFE\xFF");
+		const std::string bom_le32( "\xFF\xFE\0\0", 4);
+		const std::string bom_be32( "\0\0\xFE\xFF", 4);
+
+		if (!testEncoding( "UTF-8 without header", charset::UTF8(), "", 0, XMLEncoding::UTF8)
+		||  !testEncoding( "UTF-8", charset::UTF8(), "", "UTF-8", XMLEncoding::UTF8)
+		||  !testEncoding( "UTF-8 BOM", charset::UTF8(), bom_utf8, 0, XMLEncoding::UTF8)
+		||  !testEncoding( "ISO-8859-1", charset::IsoLatin( 1), "", "ISO-8859-1", XMLEncoding::IsoLatin, 1)
+		||  !testEncoding( "ISO-8859-15", charset::IsoLatin( 9), "", "iso-8859-15", XMLEncoding::IsoLatin, 9)
+		||  !testEncoding( "IsoLatin-2", charset::IsoLatin( 2), "", "IsoLatin-2", XMLEncoding::IsoLatin, 2)
+		||  !testEncoding( "UTF-16LE without BOM", charset::UTF16LE(), "", "UTF-16", XMLEncoding::UTF16LE)
+		||  !testEncoding( "UTF-16BE without BOM", charset::UTF16BE(), "", 0, XMLEncoding::UTF16BE)
+		||  !testEncoding( "UTF-16LE", charset::UTF16LE(), bom_le16, "UTF-16", XMLEncoding::UTF16LE)
+		||  !testEncoding( "UTF-16BE", charset::UTF16BE(), bom_be16, "UTF-16", XMLEncoding::UTF16BE)
+		||  !testEncoding( "UCS-2LE", charset::UCS2LE(), bom_le16, "UCS-2", XMLEncoding::UCS2LE)
+		||  !testEncoding( "UCS-2BE", charset::UCS2BE(), "", "ISO-10646-UCS-2", XMLEncoding::UCS2BE)
+		||  !testEncoding( "UCS-4LE", charset::UCS4LE(), bom_le32, "UCS-4", XMLEncoding::UCS4LE)
+		||  !testEncoding( "UCS-4BE", charset::UCS4BE(), bom_be32, 0, XMLEncoding::UCS4BE)
+		||  !testEncoding( "UCS-4LE without BOM", charset::UCS4LE(), "", 0, XMLEncoding::UCS4LE))
+		{
+			return 1;
+		}
+		bool unknownEncodingRejected = false;
+		try
+		{
+			static const char* doc = "<?xml version='1.0' encoding='EBCDIC-US'?><doc/>";
+			XMLEncoding::detect( doc, std::char_traits<char>::length( doc));
+		}
+		catch (const exception& ee)
+		{
+			unknownEncodingRejected = (ee.cause == throws_exception::EncodingNotSupported);
+		}
+		if (!unknownEncodingRejected)
+		{
+			std::cerr << "unknown encoding not rejected" << std::endl;
+			return 1;
+		}
+		std::cerr << "OK" << std::endl;
+		return 0;
+	}
+	catch (const std::exception& ee)
+	{
+		std::cerr << "ERROR " << ee.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,99 @@
+#include "textwolf.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <map>
+
+//build gcc
+//compile: g++ -c -o test_SymbolTable.o -g -I../include/ -pedantic -Wall -O4 test_SymbolTable.cpp
+//link: g++ -lc -o test_SymbolTable test_SymbolTable.o
+//build windows
+//compile: cl.exe /wd4996 /Ob2 /O2 /EHsc /MT /W4 /nologo /I..\include /D "WIN32" /D "_WINDOWS" /Fo"test_SymbolTable.obj" test_SymbolTable.cpp
+//link: link.exe /out:.\test_SymbolTable test_SymbolTable.obj
+
+using namespace textwolf;
+
+static std::string symbolName( unsigned int idx)
+{
+	static const char* prefix[] = {"a","al","alpha","Alpha","b","bet","beta","","x"};
+	std::ostringstream rt;
+	rt << prefix[ idx % 9];
+	for (idx /= 9; idx; idx /= 26) rt << (char)('a' + idx % 26);
+	return rt.str();
+}
+
+int main( int, const char**)
+{
+	try
+	{
+		enum {NofSymbols=3000};
+		std::map<std::string,int> def;
+		SymbolTable symtab;
+		for (unsigned int ii=0; ii<NofSymbols; ++ii)
+		{
+			std::string name = symbolName( ii);
+			int id = symtab.insert( name.c_str(), name.size());
+			if (def.find( name) == def.end())
+			{
+				if (id != (int)def.size() + 1)
+				{
+					std::cerr << "FAILED identifier " << id << " of '" << name << "' not assigned in ascending order" << std::endl;
+					return 1;
+				}
+				def[ name] = id;
+			}
+			else if (def[ name] != id)
+			{
+				std::cerr << "FAILED identifier of '" << name << "' changed on second insert" << std::endl;
+				return 1;
+			}
+		}
+		if (symtab.size() != def.size())
+		{
+			std::cerr << "FAILED size " << symtab.size() << " != " << def.size() << std::endl;
+			return 1;
+		}
+		std::map<std::string,int>::const_iterator di = def.begin(), de = def.end();
+		for (; di != de; ++di)
+		{
+			if (symtab.get( di->first.c_str(), di->first.size()) != di->second
+			||  std::string( symtab.key( di->second), symtab.keysize( di->second)) != di->first)
+			{
+				std::cerr << "FAILED get '" << di->first << "'" << std::endl;
+				return 1;
+			}
+			std::string unknown = di->first + "Q";
+			if (symtab.get( unknown.c_str(), unknown.size()) != 0)
+			{
+				std::cerr << "FAILED found undefined '" << unknown << "'" << std::endl;
+				return 1;
+			}
+		}
+		// ... the scanner resolves the element names with the table of the automaton
+		typedef XMLPathSelectAutomaton<charset::UTF8> Automaton;
+		typedef XMLScanner<SrcIterator,charset::UTF8,charset::UTF8,std::string> Scanner;
+		Automaton atm;
+		(*atm)["doc"]["item"]("id") = 1;
+		static const char* doc = "<doc><item id='1'>text</item><other/></doc>";
+		Scanner xs( SrcIterator( doc, std::strlen( doc)));
+		xs.setSymbolTable( &atm.symbols());
+		std::ostringstream out;
+		for (Scanner::ElementType et = xs.nextItem(); et != Scanner::Exit && et != Scanner::ErrorOccurred; et = xs.nextItem())
+		{
+			int sym = xs.getItemSymbol();
+			out << std::string( xs.getItemPtr(), xs.getItemSize()) << "=" << (sym ? std::string( atm.symbols().key( sym), atm.symbols().keysize( sym)) : "") << " ";
+		}
+		if (out.str() != "doc=doc item=item id=id 1= text= item=item other= = doc=doc ")
+		{
+			std::cerr << "FAILED resolving element names in the scanner: " << out.str() << std::endl;
+			return 1;
+		}
+		std::cerr << "OK" << std::endl;
+		return 0;
+	}
+	catch (const std::exception& ee)
+	{
+		std::cerr << "ERROR " << ee.what() << std::endl;
+		return 1;
+	}
+}
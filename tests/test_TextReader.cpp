@@ -25,7 +25,7 @@ unsigned int character( unsigned int idx, unsigned int maxchar)
 	rt = ((rt % (maxchar-1)) + 1);
 	if (maxchar == 0x10FFFF/*UTF-16 HACK*/)
 	{
-		if (rt >= 0xD800 && rt < 0xDC00) rt = rt - 0xD800;
+		if (rt >= 0xD800 && rt < 0xE000) rt = rt - 0xD800;
 	}
 	return rt;
 }
@@ -154,6 +154,45 @@ struct TextScannerTest
 	}
 };
 
+/// \brief Test the reverse mapping of all IsoLatin code pages: every character of a code page maps back to its position, characters not in the code page map to 0
+static unsigned int testCodePages()
+{
+	unsigned int idx = 1;
+	for (; idx <= 9; ++idx)
+	{
+		charset::IsoLatin cp( idx);
+		unsigned int nofMapped = 0;
+		unsigned int ii = 128;
+		for (; ii < 256; ++ii)
+		{
+			UChar chr = cp.ucharcode( (char)ii);
+			if (!chr) continue;
+			unsigned char inv = (unsigned char)cp.invcode( chr);
+			if (cp.ucharcode( (char)inv) != chr)
+			{
+				printf ("code page %u character %u maps back to %u\n", idx, chr, inv);
+				return idx;
+			}
+		}
+		for (ii = 128; ii < 0x10000; ++ii)
+		{
+			unsigned char inv = (unsigned char)cp.invcode( ii);
+			if (inv)
+			{
+				++nofMapped;
+				if (cp.ucharcode( (char)inv) != ii)
+				{
+					printf ("code page %u character %u maps to %u\n", idx, ii, inv);
+					return idx;
+				}
+			}
+		}
+		if (nofMapped == 0) return idx;
+	}
+	printf ("PASSED Test IsoLatin code pages\n");
+	return 0;
+}
+
 static const char* testAll()
 {
 	struct Error
@@ -191,6 +230,7 @@ static const char* testAll()
 	||  error.get( "UCS4LE",	*TextScannerTest< charset::UCS4LE>( "UCS-4LE"))
 	||  error.get( "UTF16BE",	*TextScannerTest< charset::UTF16BE>( "UTF-16BE"))
 	||  error.get( "UTF16LE",	*TextScannerTest< charset::UTF16LE>( "UTF-16LE"))
+	||  error.get( "IsoLatin code pages", testCodePages())
 	) return *error;
 	return 0;
 }
@@ -0,0 +1,183 @@
+#include "textwolf.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+//build gcc
+//compile: g++ -c -o test_UTF8Block.o -g -I../include/ -pedantic -Wall -O4 test_UTF8Block.cpp
+//link: g++ -lc -o test_UTF8Block test_UTF8Block.o
+//build windows
+//compile: cl.exe /wd4996 /Ob2 /O2 /EHsc /MT /W4 /nologo /I..\include /D "WIN32" /D "_WINDOWS" /Fo"test_UTF8Block.obj" test_UTF8Block.cpp
+//link: link.exe /out:.\test_UTF8Block test_UTF8Block.obj
+
+using namespace textwolf;
+
+/// \brief Encode a character as UTF-8 without any check (also surrogates, 5 and 6 byte forms, overlong with minimum length 'minlen')
+static std::string encode( UChar chr, unsigned int minlen=1)
+{
+	std::string rt;
+	unsigned int len = (chr < 0x80) ? 1 : (chr < 0x800) ? 2 : (chr < 0x10000) ? 3 : (chr < 0x200000) ? 4 : (chr < 0x4000000) ? 5 : 6;
+	if (len < minlen) len = minlen;
+	if (len == 1)
+	{
+		rt.push_back( (char)chr);
+		return rt;
+	}
+	static const unsigned char lead[7] = {0,0,0xC0,0xE0,0xF0,0xF8,0xFC};
+	rt.push_back( (char)(lead[ len] | (chr >> (6 * (len-1)))));
+	for (unsigned int ii=len-1; ii>0; --ii)
+	{
+		rt.push_back( (char)(0x80 | ((chr >> (6 * (ii-1))) & 0x3F)));
+	}
+	return rt;
+}
+
+/// \brief Reference implementation of a strict validator: decode every sequence and check it against the shortest encoding of the character
+static std::size_t referenceValidLength( const std::string& src)
+{
+	std::size_t pos = 0;
+	while (pos < src.size())
+	{
+		unsigned char c0 = (unsigned char)src[pos];
+		unsigned int len = (c0 < 0x80) ? 1 : (c0 < 0xC0) ? 0 : (c0 < 0xE0) ? 2 : (c0 < 0xF0) ? 3 : (c0 < 0xF8) ? 4 : 0;
+		if (!len || pos + len > src.size()) return pos;
+		UChar chr = (len == 1) ? c0 : (c0 & (0x7F >> len));
+		for (unsigned int ii=1; ii<len; ++ii)
+		{
+			unsigned char cc = (unsigned char)src[pos+ii];
+			if ((cc & 0xC0) != 0x80) return pos;
+			chr = (chr << 6) | (cc & 0x3F);
+		}
+		if (chr > 0x10FFFF || (chr >= 0xD800 && chr <= 0xDFFF) || encode( chr) != src.substr( pos, len)) return pos;
+		pos += len;
+	}
+	return pos;
+}
+
+static bool check( const char* what, bool cond)
+{
+	if (!cond) std::cerr << "FAILED " << what << std::endl;
+	return cond;
+}
+
+int main( int, const char**)
+{
+	try
+	{
+		// ... all characters are accepted and decoded, surrogates rejected
+		std::string all;
+		std::vector<UChar> allchr;
+		for (UChar chr=1; chr<=0x10FFFF; ++chr)
+		{
+			std::string enc = encode( chr);
+			bool surrogate = (chr >= 0xD800 && chr <= 0xDFFF);
+			if (!check( "sequence length", UTF8Block::sequenceLength( enc.c_str(), enc.size()) == (surrogate ? 0 : enc.size()))) return 1;
+			if (surrogate) continue;
+			if (!check( "decode", UTF8Block::decode( enc.c_str(), enc.size()) == chr)) return 1;
+			if ((chr & 0xFF) == 0 || chr < 0x800)
+			{
+				all.append( enc);
+				allchr.push_back( chr);
+				if (chr % 7 == 0)
+				{
+					all.append( "ascii run of some length with more than 32 characters ");
+					for (const char* cc = "ascii run of some length with more than 32 characters "; *cc; ++cc) allchr.push_back( (unsigned char)*cc);
+				}
+			}
+		}
+		// ... rejected: overlong encodings, characters above 0x10FFFF, 5 and 6 byte forms, incomplete characters, lonely continuation bytes
+		static const UChar overlong[] = {0x0,0x41,0x7F,0x80,0x7FF,0x800,0xFFFF};
+		for (unsigned int oi=0; oi<sizeof(overlong)/sizeof(overlong[0]); ++oi)
+		{
+			unsigned int minlen = (overlong[oi] < 0x80) ? 2 : (overlong[oi] < 0x800) ? 3 : 4;
+			std::string enc = encode( overlong[oi], minlen);
+			if (!check( "overlong", UTF8Block::sequenceLength( enc.c_str(), enc.size()) == 0)) return 1;
+		}
+		static const UChar toobig[] = {0x110000,0x1FFFFF,0x200000,0x7FFFFFFF,0};
+		for (unsigned int ti=0; toobig[ti]; ++ti)
+		{
+			std::string enc = encode( toobig[ti]);
+			if (!check( "too big", UTF8Block::validLength( enc.c_str(), enc.size()) == 0)) return 1;
+		}
+		std::string euro = encode( 0x20AC);
+		if (!check( "incomplete", UTF8Block::validLength( euro.c_str(), 2) == 0)) return 1;
+		if (!check( "continuation", UTF8Block::validLength( "a\x80", 2) == 1)) return 1;
+		if (!check( "null terminated", UTF8Block::multiByteLength( "\xE2\x82", 0) == 0 && UTF8Block::multiByteLength( euro.c_str(), 0) == 3)) return 1;
+
+		// ... valid block conversion compared with character by character decoding
+		if (!check( "valid block", UTF8Block::isValid( all.c_str(), all.size()))) return 1;
+		std::vector<UChar> ucs4( all.size());
+		std::size_t ucs4size;
+		if (!check( "convert to UCS-4", UTF8Block::convertToUCS4( all.c_str(), all.size(), &ucs4[0], ucs4size) && ucs4size == allchr.size())) return 1;
+		ucs4.resize( ucs4size);
+		if (!check( "UCS-4 result", ucs4 == allchr)) return 1;
+		std::vector<unsigned short> utf16( all.size());
+		std::size_t utf16size;
+		if (!check( "convert to UTF-16", UTF8Block::convertToUTF16( all.c_str(), all.size(), &utf16[0], utf16size))) return 1;
+		std::string utf16ref;
+		charset::UTF16LE utf16le;
+		for (std::size_t ci=0; ci<allchr.size(); ++ci) utf16le.print( allchr[ci], utf16ref);
+		if (!check( "UTF-16 size", utf16size * 2 == utf16ref.size())) return 1;
+		for (std::size_t ui=0; ui<utf16size; ++ui)
+		{
+			unsigned short ref = (unsigned short)((unsigned char)utf16ref[ui*2] | ((unsigned char)utf16ref[ui*2+1] << 8));
+			if (!check( "UTF-16 result", utf16[ui] == ref)) return 1;
+		}
+
+		// ... random byte sequences with mostly valid characters compared with the reference implementation
+		unsigned int rnd = 1;
+		for (unsigned int ri=0; ri<20000; ++ri)
+		{
+			std::string block;
+			unsigned int nn = ri % 64;
+			for (unsigned int ii=0; ii<nn; ++ii)
+			{
+				rnd = rnd * 1103515245U + 12345U;
+				unsigned int rr = (rnd >> 8);
+				if (rr % 16 == 0) block.push_back( (char)(rr >> 8));
+				else if (rr % 3 == 0) block.append( encode( (rr >> 8) % 0x110000));
+				else block.push_back( (char)('a' + (rr >> 8) % 26));
+			}
+			std::size_t expected = referenceValidLength( block);
+			if (!check( "random block", UTF8Block::validLength( block.c_str(), block.size()) == expected)) return 1;
+			std::vector<UChar> dest( block.size()+1);
+			std::size_t destsize;
+			if (!check( "random block conversion", UTF8Block::convertToUCS4( block.c_str(), block.size(), &dest[0], destsize) == (expected == block.size()))) return 1;
+		}
+
+		// ... block conversion to single byte code pages, long ASCII runs to cover the vectorized copy
+		std::string ascii( "The quick brown fox jumps over the lazy dog 0123456789");
+		std::string latin = ascii + encode( 0x20AC) + ascii + encode( 0xE9) + "x";
+		std::vector<char> cpout( latin.size());
+		std::size_t cpsize;
+		charset::IsoLatin latin9( 9);
+		std::size_t cpconv = UTF8Block::convertToCodePage( latin.c_str(), latin.size(), latin9, &cpout[0], cpsize);
+		std::string latin9ref = ascii + "\xA4" + ascii + "\xE9" + "x";
+		if (!check( "convert to ISO-8859-9", cpconv == latin.size() && std::string( &cpout[0], cpsize) == latin9ref)) return 1;
+		charset::IsoLatin latin2( 2);
+		std::string ccaron = ascii + encode( 0x10C) + encode( 0x20AC) + "y";
+		cpconv = UTF8Block::convertToCodePage( ccaron.c_str(), ccaron.size(), latin2, &cpout[0], cpsize);
+		if (!check( "not representable in ISO-8859-2", cpconv == ascii.size() + 2 && std::string( &cpout[0], cpsize) == ascii + "\xC8")) return 1;
+		std::string badcp = ascii + ascii + "\xE2\x82" + "z";
+		cpconv = UTF8Block::convertToCodePage( badcp.c_str(), badcp.size(), latin9, &cpout[0], cpsize);
+		if (!check( "malformed for ISO-8859-9", cpconv == ascii.size() * 2 && std::string( &cpout[0], cpsize) == ascii + ascii)) return 1;
+
+		// ... strict decoding in the character set encoding, malformed characters are consumed only up to the first byte not continuing them
+		typedef TextScanner<CStringIterator,charset::UTF8> Reader;
+		std::string invalid = std::string("A") + encode( 0x20AC) + encode( 0x41, 2) + encode( 0xD800) + encode( 0x110000) + "\xF8" + "B" + "\xE2\x82" + "<";
+		Reader reader( CStringIterator( invalid.c_str(), invalid.size()));
+		enum {X=charset::UTF8::InvalidChar};
+		static const UChar expectedchr[] = {0x41,0x20AC,X,X,X,X,X,X,X,X,X,X,0x42,X,'<',0};
+		for (unsigned int ei=0; expectedchr[ei]; ++ei,++reader)
+		{
+			if (!check( "strict decoding", reader.chr() == expectedchr[ei])) return 1;
+		}
+		std::cerr << "OK" << std::endl;
+		return 0;
+	}
+	catch (const std::exception& ee)
+	{
+		std::cerr << "ERROR " << ee.what() << std::endl;
+		return 1;
+	}
+}
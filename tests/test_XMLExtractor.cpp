@@ -0,0 +1,121 @@
+#include "textwolf.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstring>
+
+//build gcc
+//compile: g++ -c -o test_XMLExtractor.o -g -I../include/ -pedantic -Wall -O4 test_XMLExtractor.cpp
+//link: g++ -lc -o test_XMLExtractor test_XMLExtractor.o
+//build windows
+//compile: cl.exe /wd4996 /Ob2 /O2 /EHsc /MT /W4 /nologo /I..\include /D "WIN32" /D "_WINDOWS" /Fo"test_XMLExtractor.obj" test_XMLExtractor.cpp
+//link: link.exe /out:.\test_XMLExtractor test_XMLExtractor.obj
+
+using namespace textwolf;
+
+typedef XMLPathSelectAutomaton<charset::UTF8> Automaton;
+typedef XMLPathSelect<charset::UTF8> Selector;
+typedef XMLScanner<SrcIterator,charset::UTF8,charset::UTF8,std::string> Scanner;
+
+/// \brief Handler printing the elements selected
+struct PrintHandler
+{
+	std::ostringstream out;
+
+	void selected( int typeidx, XMLScannerBase::ElementType type, const char* content, std::size_t size)
+	{
+		out << typeidx << " " << XMLScannerBase::getElementTypeName( type) << " '" << std::string( content, size) << "'" << std::endl;
+	}
+};
+
+/// \brief Select the elements of a document with the scanner and selector loop written by hand
+static std::string selectExpected( const Automaton& atm, const char* doc)
+{
+	Scanner xs( SrcIterator( doc, std::strlen( doc)));
+	Selector sel( &atm);
+	PrintHandler handler;
+	for (;;)
+	{
+		XMLScannerBase::ElementType type = xs.nextItem();
+		if (type == XMLScannerBase::Exit || type == XMLScannerBase::ErrorOccurred) break;
+		std::string content( xs.getItemPtr(), xs.getItemSize());
+		Selector::iterator itr = sel.push( type, content), end = sel.end();
+		for (; itr != end; ++itr)
+		{
+			handler.selected( *itr, type, content.c_str(), content.size());
+		}
+	}
+	return handler.out.str();
+}
+
+/// \brief Select the elements of a document with XMLExtractor feeding the document in chunks
+static std::string selectExtractor( const Automaton& atm, const char* doc, std::size_t chunksize)
+{
+	Scanner xs;
+	Selector sel( &atm);
+	PrintHandler handler;
+	XMLExtractor<Scanner,Selector,PrintHandler> extractor( xs, sel, handler);
+	std::size_t docsize = std::strlen( doc), pos = 0;
+	for (;;)
+	{
+		std::size_t size = (docsize - pos < chunksize) ? (docsize - pos) : chunksize;
+		xs.feed( doc + pos, size, pos + size == docsize);
+		pos += size;
+		XMLScannerBase::ElementType type = extractor.run();
+		if (type == XMLScannerBase::ErrorOccurred) return handler.out.str() + "ERROR";
+		if (type == XMLScannerBase::Exit) break;
+	}
+	return handler.out.str();
+}
+
+/// \brief Compare the results of XMLExtractor with the ones of the loop written by hand for all chunk sizes
+static bool checkExtractor( const char* name, const Automaton& atm, const char* doc)
+{
+	std::string expected = selectExpected( atm, doc);
+	for (std::size_t chunksize = 1; chunksize <= std::strlen( doc); chunksize = chunksize * 2 + 1)
+	{
+		std::string result = selectExtractor( atm, doc, chunksize);
+		if (result != expected)
+		{
+			std::cerr << "FAILED " << name << " with chunk size " << chunksize << ":" << std::endl << expected << std::endl << result << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main( int, const char**)
+{
+	try
+	{
+		static const char* doc =
+			"<?xml version='1.0'?>"
+			"<doc><skipped><deep a='1'>x<deeper b='2'/></deep><!-- <rec id='0'> --></skipped>"
+			"<rec id='1' name='a'><v>first</v><w>not selected</w></rec>"
+			"<other><rec id='9'>below other</rec></other>"
+			"<rec id='2'><v>second</v><sub><v>third</v></sub></rec>"
+			"<x><y><z>deep z</z></y></x><x><y>no z</y></x>"
+			"</doc>";
+		Automaton atm;
+		(*atm)["doc"]["rec"]("id") = 1;
+		(*atm)["doc"]["rec"]["v"]() = 2;
+		(*atm)["doc"]["rec"]--["v"]() = 3;
+		(*atm)["doc"]["x"]--["z"]() = 4;
+		if (!checkExtractor( "paths", atm, doc)) return 1;
+
+		// ... outputs without element type are triggered by the element following the one matched, whatever its type
+		Automaton atm2;
+		(*atm2).FROM(2) = 1;
+		if (!checkExtractor( "trigger", atm2, doc)) return 1;
+		(*atm2)["doc"]["rec"]("id").TO(0) = 2;
+		(*atm2)["doc"]["x"]--["y"] = 3;
+		if (!checkExtractor( "triggers", atm2, doc)) return 1;
+		std::cerr << "OK" << std::endl;
+		return 0;
+	}
+	catch (const std::exception& ee)
+	{
+		std::cerr << "ERROR " << ee.what() << std::endl;
+		return 1;
+	}
+}
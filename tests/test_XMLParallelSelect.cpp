@@ -0,0 +1,170 @@
+#include "textwolf.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//build gcc
+//compile: g++ -c -o test_XMLParallelSelect.o -g -I../include/ -pedantic -Wall -O4 test_XMLParallelSelect.cpp
+//link: g++ -lc -pthread -o test_XMLParallelSelect test_XMLParallelSelect.o
+//build windows
+//compile: cl.exe /wd4996 /Ob2 /O2 /EHsc /MT /W4 /nologo /I..\include /D "WIN32" /D "_WINDOWS" /Fo"test_XMLParallelSelect.obj" test_XMLParallelSelect.cpp
+//link: link.exe /out:.\test_XMLParallelSelect test_XMLParallelSelect.obj
+
+using namespace textwolf;
+
+typedef XMLPathSelectAutomaton<charset::UTF8> Automaton;
+typedef XMLParallelSelect<charset::UTF8> MyXMLParallelSelect;
+
+static std::string createDocument( unsigned int nofRecords)
+{
+	std::ostringstream rt;
+	rt << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		<< "<!DOCTYPE doc [ <!ELEMENT doc (rec)*> ]>\n"
+		<< "<doc id='d1' note=\"a > b\">\n";
+	for (unsigned int ii=0; ii<nofRecords; ++ii)
+	{
+		rt << "<!-- record " << ii << " <rec> -->\n";
+		rt << "<rec id='" << ii << "' tag=\"a>/b\">";
+		rt << "<name>N&amp;" << ii << "</name>";
+		if (ii % 3 == 0) rt << "<![CDATA[<rec id='x'>" << ii << "]]>";
+		if (ii % 4 == 0) rt << "<?pi <rec>?>";
+		rt << "<sub><name>S" << ii << "</name><val x='" << (ii*7) << "'/></sub>";
+		rt << "</rec>\n";
+	}
+	rt << "</doc>\n";
+	return rt.str();
+}
+
+static void defineAutomaton( Automaton& atm)
+{
+	(*atm)["doc"]("id") = 1;
+	(*atm)["doc"]["rec"]("id") = 2;
+	(*atm)["doc"]["rec"]["name"]() = 3;
+	(*atm)--["val"]("x") = 4;
+	(*atm)["doc"]["rec"]["sub"]--["name"]() = 5;
+	(*atm)["doc"]["rec"]() = 6;
+}
+
+struct Selected
+{
+	int type;
+	std::size_t position;
+	std::string content;
+
+	bool operator==( const Selected& o) const
+	{
+		return type == o.type && position == o.position && content == o.content;
+	}
+};
+
+static std::vector<Selected> selectSequential( const Automaton& atm, const std::string& doc)
+{
+	typedef XMLScanner<char*,charset::UTF8,charset::UTF8,std::string> MyXMLScanner;
+	typedef XMLPathSelect<charset::UTF8> MyXMLPathSelect;
+	std::vector<Selected> rt;
+	MyXMLScanner xs( const_cast<char*>( doc.c_str()));
+	MyXMLPathSelect sel( &atm);
+	for (;;)
+	{
+		XMLScannerBase::ElementType et = xs.nextItem();
+		if (et == XMLScannerBase::Exit || et == XMLScannerBase::ErrorOccurred) break;
+		MyXMLPathSelect::iterator si = sel.push( et, xs.getItemPtr(), xs.getItemSize()), se = sel.end();
+		for (; si != se; ++si)
+		{
+			Selected elem;
+			elem.type = *si;
+			elem.position = xs.getTokenPosition();
+			elem.content = std::string( xs.getItemPtr(), xs.getItemSize());
+			rt.push_back( elem);
+		}
+	}
+	return rt;
+}
+
+static bool checkParallel( const Automaton& atm, const std::string& doc, const std::vector<Selected>& expected, unsigned int nofThreads, std::size_t chunkSize)
+{
+	MyXMLParallelSelect psel( &atm, nofThreads, 1, chunkSize);
+	if (!psel.run( doc.c_str(), doc.size()))
+	{
+		std::cerr << "ERROR " << psel.getError() << std::endl;
+		return false;
+	}
+	const std::vector<MyXMLParallelSelect::Element>& result = psel.result();
+	if (result.size() != expected.size())
+	{
+		std::cerr << "DIFF number of elements " << result.size() << " != " << expected.size() << " (threads " << nofThreads << ")" << std::endl;
+		return false;
+	}
+	for (std::size_t ii=0; ii<result.size(); ++ii)
+	{
+		Selected elem;
+		elem.type = result[ii].type;
+		elem.position = result[ii].position;
+		elem.content = std::string( result[ii].content, result[ii].size);
+		if (!(elem == expected[ii]))
+		{
+			std::cerr << "DIFF element " << ii << " (threads " << nofThreads << "): "
+				<< elem.type << " " << elem.position << " '" << elem.content << "' != "
+				<< expected[ii].type << " " << expected[ii].position << " '" << expected[ii].content << "'" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main( int, const char**)
+{
+	try
+	{
+		Automaton atm;
+		defineAutomaton( atm);
+		std::string doc = createDocument( 200);
+		std::vector<Selected> expected = selectSequential( atm, doc);
+		if (expected.size() < 200*4)
+		{
+			std::cerr << "FAILED too few elements selected: " << expected.size() << std::endl;
+			return 1;
+		}
+		static const unsigned int threads[] = {1,2,4,7,0};
+		static const std::size_t chunkSizes[] = {1,100,1000,1<<20,0};
+		for (unsigned int ti=0; threads[ti]; ++ti)
+		{
+			for (unsigned int ci=0; chunkSizes[ci]; ++ci)
+			{
+				if (!checkParallel( atm, doc, expected, threads[ti], chunkSizes[ci])) return 1;
+			}
+		}
+		// an error is reported with the elements selected before it
+		std::string baddoc = doc;
+		std::size_t errpos = baddoc.find( "<rec id='150'");
+		baddoc[ errpos+1] = '=';
+		MyXMLParallelSelect psel( &atm, 4, 1, 100);
+		if (psel.run( baddoc.c_str(), baddoc.size()) || !psel.getError())
+		{
+			std::cerr << "FAILED error not detected" << std::endl;
+			return 1;
+		}
+		std::vector<MyXMLParallelSelect::Element>::const_iterator ri = psel.result().begin(), re = psel.result().end();
+		for (; ri != re; ++ri)
+		{
+			if (ri->position >= errpos)
+			{
+				std::cerr << "FAILED element selected after error" << std::endl;
+				return 1;
+			}
+		}
+		if (psel.result().size() < 150*4)
+		{
+			std::cerr << "FAILED elements before error missing: " << psel.result().size() << std::endl;
+			return 1;
+		}
+		std::cerr << "OK" << std::endl;
+		return 0;
+	}
+	catch (const std::exception& ee)
+	{
+		std::cerr << "ERROR " << ee.what() << std::endl;
+		return 1;
+	}
+}
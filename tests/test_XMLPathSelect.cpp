@@ -2,6 +2,9 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <sstream>
+#include <vector>
+#include <cstring>
 
 //build gcc
 //compile: g++ -c -o test_XMLPathSelect.o -g -I../include/ -pedantic -Wall -O4 test_XMLPathSelect.cpp
@@ -30,6 +33,99 @@ class ProtocolCharMap
 	}
 };
 
+typedef XMLPathSelectAutomaton<charset::UTF8> Automaton;
+typedef XMLPathSelect<charset::UTF8> MyXMLPathSelect;
+typedef XMLScanner<char*,charset::IsoLatin,charset::IsoLatin,std::string> MyXMLScanner;
+
+/// \brief Handler printing the elements selected (see XMLPathSelect::select(XMLScannerBase::ElementType,const char*,std::size_t,int,Handler&))
+struct PrintHandler
+{
+	std::ostream* out;
+	const std::string* content;
+
+	PrintHandler( std::ostream& out_, const std::string& content_) :out(&out_),content(&content_){}
+
+	void operator()( int typeidx)
+	{
+		*out << "Element " << typeidx << ": " << *content << std::endl;
+	}
+};
+
+/// \brief Check that loading an image fails with InvalidImage
+static bool loadRejected( const std::string& image)
+{
+	Automaton atm;
+	try
+	{
+		atm.load( image.c_str(), image.size());
+		return false;
+	}
+	catch (const textwolf::exception& ee)
+	{
+		return ee.cause == throws_exception::InvalidImage;
+	}
+}
+
+/// \brief Words of the compiled index of an image, that starts at 'indexpos' (see XMLPathSelectAutomaton::CompiledIndex::serialize(BinaryImageWriter&)const)
+struct IndexImage
+{
+	std::string prefix;
+	std::vector<unsigned int> ar;
+	std::size_t chainslot, visitofs, offsets, entries, mask;	//< positions of the arrays in 'ar' (after their size)
+
+	IndexImage( const std::string& image, std::size_t indexpos)
+		:prefix(image.substr( 0, indexpos)),ar((image.size() - indexpos) / sizeof(unsigned int))
+	{
+		std::memcpy( &ar[0], image.c_str() + indexpos, ar.size() * sizeof(unsigned int));
+		chainslot = 1;
+		visitofs = chainslot + ar[ chainslot-1] + 1;
+		offsets = visitofs + ar[ visitofs-1] + 1;
+		entries = offsets + ar[ offsets-1] + 1;
+		mask = entries + ar[ entries-1];
+	}
+
+	std::string image() const
+	{
+		return prefix + std::string( (const char*)&ar[0], ar.size() * sizeof(unsigned int));
+	}
+};
+
+/// \brief Select the elements of a document and print them, with the fast paths (skipping the subtrees without anything to select, masking the output of elements not selected, the elements resolved to symbols by the scanner and results passed to a handler) if 'fast' is set
+template <class Selector>
+static std::string selectElements( char* src, const Automaton& atm, Selector& xs, bool fast, unsigned int& nofItems)
+{
+	std::ostringstream out;
+	MyXMLScanner xc( src);
+	xc.setSymbolTable( &atm.symbols());
+	MyXMLScanner::ElementType type = xc.nextItem();
+	for (nofItems=0; type != MyXMLScanner::Exit && type != MyXMLScanner::ErrorOccurred; ++nofItems)
+	{
+		std::string content( xc.getItemPtr(), xc.getItemSize());
+		if (fast)
+		{
+			PrintHandler handler( out, content);
+			xs.select( type, xc.getItemPtr(), xc.getItemSize(), xc.getItemSymbol(), handler);
+		}
+		else
+		{
+			typename Selector::iterator itr = xs.push( type, content),end = xs.end();
+			for (; itr!=end; itr++)
+			{
+				out << "Element " << *itr << ": " << content << std::endl;
+			}
+		}
+		type = !fast ? xc.nextItem() : xs.subtreeIsIrrelevant() ? xc.skipSubtree() : xc.nextItem( xs.outputMask());
+	}
+	if (type == MyXMLScanner::ErrorOccurred) out << "ERROR " << xc.getItemPtr() << std::endl;
+	return out.str();
+}
+
+static std::string selectElements( char* src, const Automaton& atm, bool fast, unsigned int& nofItems)
+{
+	MyXMLPathSelect xs( &atm);
+	return selectElements( src, atm, xs, fast, nofItems);
+}
+
 int main( int, const char**)
 {
 	try
@@ -53,7 +149,6 @@ int main( int, const char**)
 			"<Y><mm q='2'>18</mm></Y><Y><z><zz e='2'>18</zz></z></Y>"
 		);
 		//[2] creating the automaton
-		typedef XMLPathSelectAutomaton<charset::UTF8> Automaton;
 		Automaton atm;
 		(*atm)["TT"]("c") = 6;
 		(*atm)["TT"]("c")() = 7;
@@ -71,9 +166,6 @@ int main( int, const char**)
 
 		std::cout << "AUTOMATON:" << std::endl << atm.tostring() << std::endl;
 		//[3] define the XML Path selection by the automaton over the source iterator
-		typedef XMLPathSelect<charset::UTF8> MyXMLPathSelect;
-		typedef XMLScanner<char*,charset::IsoLatin,charset::IsoLatin,std::string> MyXMLScanner;
-
 		MyXMLScanner xc( src);
 		MyXMLPathSelect xs( &atm);
 
@@ -97,11 +189,148 @@ int main( int, const char**)
 			std::cerr << "FAILED " << ci->content() << std::endl;
 			return 1;
 		}
-		else
+		//[6] check that the fast paths (skipping the subtrees without anything to select, output mask, symbols, result handler) do not change the result
+		Automaton atm2;
+		(*atm2)["TT"]("i","9")--() = 9;
+		(*atm2)["TT"]["AA"]["BB"] = 10;
+		(*atm2)["X"]--["CC"] = 15;
+		(*atm2)["Y"]--("q","1")() = 17;
+		unsigned int nofItems = 0, nofItemsPruned = 0;
+		std::string expected = selectElements( src, atm2, false, nofItems);
+		std::string pruned = selectElements( src, atm2, true, nofItemsPruned);
+		if (pruned != expected || nofItemsPruned >= nofItems)
 		{
-			std::cerr << "OK" << std::endl;
-			return 0;
+			std::cerr << "FAILED pruning subtrees (" << nofItemsPruned << " of " << nofItems << " items scanned):" << std::endl << expected << std::endl << pruned << std::endl;
+			return 1;
+		}
+		//[7] check that a compiled automaton selects the same elements
+		Automaton atmc( atm), atm2c( atm2);
+		atmc.compile();
+		atm2c.compile();
+		unsigned int nofItemsCompiled = 0;
+		if (selectElements( src, atmc, false, nofItemsCompiled) != selectElements( src, atm, false, nofItems)
+		||  selectElements( src, atm2c, true, nofItemsCompiled) != expected)
+		{
+			std::cerr << "FAILED selecting with compiled automaton" << std::endl;
+			return 1;
+		}
+		//[8] check that a selector with fixed size stacks reset after every document selects the same elements
+		typedef XMLPathSelect<charset::UTF8,FixedStack<64>::type> FixedXMLPathSelect;
+		FixedXMLPathSelect fxs( &atm2c);
+		for (int ii=0; ii<3; ++ii)
+		{
+			if (selectElements( src, atm2c, fxs, ii%2==0, nofItemsCompiled) != expected)
+			{
+				std::cerr << "FAILED selecting with fixed size stacks" << std::endl;
+				return 1;
+			}
+			fxs.reset();
+		}
+		FixedXMLPathSelect fxc( fxs);
+		if (selectElements( src, atm2c, fxc, true, nofItemsCompiled) != expected)
+		{
+			std::cerr << "FAILED selecting with a copy of a selector with fixed size stacks" << std::endl;
+			return 1;
+		}
+		try
+		{
+			XMLPathSelect<charset::UTF8,FixedStack<2,1>::type> fxsmall( &atm2c);
+			selectElements( src, atm2c, fxsmall, false, nofItemsCompiled);
+			std::cerr << "FAILED exceeding the capacity of fixed size stacks" << std::endl;
+			return 1;
+		}
+		catch (const textwolf::exception& ee)
+		{
+			if (ee.cause != throws_exception::DimOutOfRange)
+			{
+				std::cerr << "FAILED exceeding the capacity of fixed size stacks: " << ee.what() << std::endl;
+				return 1;
+			}
+		}
+		//[9] check that automata loaded from their binary images select the same elements
+		std::string image = atm.serialize(), image2 = atm2c.serialize();
+		Automaton atml, atm2l;
+		atml.load( image.c_str(), image.size());
+		atm2l.load( image2.c_str(), image2.size());
+		if (atml.tostring() != atm.tostring() || atml.compiledIndex() != 0 || atm2l.compiledIndex() == 0
+		||  atml.serialize() != image || atm2l.serialize() != image2
+		||  selectElements( src, atml, false, nofItems) != selectElements( src, atm, false, nofItems)
+		||  selectElements( src, atm2l, true, nofItemsCompiled) != expected)
+		{
+			std::cerr << "FAILED selecting with automaton loaded from image" << std::endl;
+			return 1;
+		}
+		try
+		{
+			atml.load( image2.c_str(), image2.size() - sizeof(unsigned int));
+			std::cerr << "FAILED loading truncated image" << std::endl;
+			return 1;
+		}
+		catch (const textwolf::exception& ee)
+		{
+			if (ee.cause != throws_exception::InvalidImage || atml.tostring() != atm.tostring())
+			{
+				std::cerr << "FAILED loading truncated image: " << ee.what() << std::endl;
+				return 1;
+			}
+		}
+		//[10] check that corrupt images are rejected and not loaded to loop forever or to address tokens out of range on selection
+		{
+			// ... the index follows the words of the same automaton without index
+			std::size_t indexpos = atm2.serialize().size();
+			IndexImage idx( image2, indexpos);
+			IndexImage cidx = idx;
+			cidx.ar[ cidx.offsets] = 1000;
+			if (idx.ar[ idx.offsets-1] == 0 || !loadRejected( cidx.image()))
+			{
+				std::cerr << "FAILED rejecting image with token offset out of range" << std::endl;
+				return 1;
+			}
+			cidx = idx;
+			cidx.ar[ cidx.chainslot] = (unsigned int)-1;
+			if (!loadRejected( cidx.image()))
+			{
+				std::cerr << "FAILED rejecting image with chain head without slot" << std::endl;
+				return 1;
+			}
+			cidx = idx;
+			for (std::size_t ei=cidx.entries; ei<cidx.mask; ei+=5)
+			{
+				cidx.ar[ ei+0] = 0;
+				cidx.ar[ ei+1] = XMLScannerBase::OpenTag;
+				cidx.ar[ ei+2] = 1;
+				cidx.ar[ ei+3] = 0;
+				cidx.ar[ ei+4] = 0;
+			}
+			if (!loadRejected( cidx.image()))
+			{
+				std::cerr << "FAILED rejecting image with full hash table" << std::endl;
+				return 1;
+			}
+			Automaton atmx( atm2);
+			atmx.states[ 0].link = 0;
+			if (!loadRejected( atmx.serialize()))
+			{
+				std::cerr << "FAILED rejecting image with link cycle" << std::endl;
+				return 1;
+			}
+		}
+		//[11] check that defining expressions again only adds their outputs and no transitions, also to an automaton loaded from an image
+		Automaton atm3( atm2);
+		(*atm3)["TT"]("i","9")--() = 9;
+		(*atm3)["X"]--["CC"] = 15;
+		(*atm2l)["TT"]("i","9")--() = 9;
+		(*atm2l)["X"]--["CC"] = 15;
+		std::size_t nofStates = atm3.states.size();
+		(*atm3)["TT"]["AA"]["DD"] = 11;
+		(*atm2l)["TT"]["AA"]["DD"] = 11;
+		if (nofStates != atm2.states.size() + 2 || atm3.states.size() != nofStates + 3 || atm2l.tostring() != atm3.tostring())
+		{
+			std::cerr << "FAILED defining transitions:" << std::endl << atm2.tostring() << std::endl << atm3.tostring() << std::endl << atm2l.tostring() << std::endl;
+			return 1;
 		}
+		std::cerr << "OK" << std::endl;
+		return 0;
 	}
 	catch (const std::runtime_error& ee)
 	{
@@ -0,0 +1,478 @@
+#include "textwolf.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <stdexcept>
+#include <fstream>
+#include <cstdio>
+
+//build gcc
+//compile: g++ -c -o test_XMLScannerBulk.o -g -I../include/ -pedantic -Wall -O4 test_XMLScannerBulk.cpp
+//link: g++ -lc -o test_XMLScannerBulk test_XMLScannerBulk.o
+//build windows
+//compile: cl.exe /wd4996 /Ob2 /O2 /EHsc /MT /W4 /nologo /I..\include /D "WIN32" /D "_WINDOWS" /Fo"test_XMLScannerBulk.obj" test_XMLScannerBulk.cpp
+//link: link.exe /out:.\test_XMLScannerBulk test_XMLScannerBulk.obj
+
+using namespace textwolf;
+
+/// \brief Iterator without window access, forces the scanner to scan character by character
+class CharwiseIterator
+{
+public:
+	CharwiseIterator( const char* src, std::size_t size)
+		:m_itr(src,size){}
+	CharwiseIterator( const CharwiseIterator& o)
+		:m_itr(o.m_itr){}
+	CharwiseIterator()
+		:m_itr(){}
+
+	char operator*()			{return *m_itr;}
+	CharwiseIterator& operator++()		{++m_itr; return *this;}
+	unsigned int pos() const		{return m_itr.pos();}
+
+private:
+	CStringIterator m_itr;
+};
+
+namespace textwolf {
+template <>
+struct Traits<CharwiseIterator>
+{
+	static inline std::size_t getPosition( const CharwiseIterator&, const CharwiseIterator& itr)
+	{
+		return itr.pos();
+	}
+};
+}//namespace
+
+template <class Iterator, class CharSet>
+static std::string scan( const Iterator& src, bool zeroCopy=false, unsigned short mask=0xFFFF)
+{
+	typedef XMLScanner<Iterator,CharSet,CharSet,std::string> Scanner;
+	Scanner xs( src);
+	if (zeroCopy && !xs.setZeroCopy()) throw std::logic_error( "zero-copy not available");
+	std::ostringstream out;
+	for (;;)
+	{
+		typename Scanner::ElementType type = xs.nextItem( mask);
+		// ... the position of the end of document differs for iterators stopping at the end of input
+		if (type != Scanner::Exit) out << xs.getTokenPosition() << " ";
+		out << Scanner::getElementTypeName( type);
+		if ((mask & (1 << type)) != 0) out << " [" << std::string( xs.getItemPtr(), xs.getItemSize()) << "]";
+		out << std::endl;
+		if (type == Scanner::ErrorOccurred || type == Scanner::Exit) break;
+	}
+	return out.str();
+}
+
+template <class CharSet>
+static std::string scanStream( const std::string& doc, std::size_t bufsize, unsigned short mask)
+{
+	std::istringstream input( doc);
+	StdInputStream stream( input);
+	return scan<IStreamIterator,CharSet>( IStreamIterator( &stream, bufsize), false, mask);
+}
+
+template <class CharSet>
+static std::string scanChunkwise( const std::string& doc, std::size_t chunksize, unsigned short mask)
+{
+	typedef XMLScanner<SrcIterator,CharSet,CharSet,std::string> Scanner;
+	Scanner xs;
+	std::ostringstream out;
+	std::string chunk;
+	std::size_t pos = 0;
+	for (;;)
+	{
+		// ... overwrite the previous chunk to detect references into it
+		chunk = doc.substr( pos, chunksize);
+		pos += chunk.size();
+		xs.feed( chunk.c_str(), chunk.size(), pos >= doc.size());
+
+		typename Scanner::ElementType type;
+		while ((type = xs.nextItem( mask)) != Scanner::None)
+		{
+			if (type != Scanner::Exit) out << xs.getTokenPosition() << " ";
+			out << Scanner::getElementTypeName( type);
+			if ((mask & (1 << type)) != 0) out << " [" << std::string( xs.getItemPtr(), xs.getItemSize()) << "]";
+			out << std::endl;
+			if (type == Scanner::ErrorOccurred || type == Scanner::Exit) return out.str();
+		}
+	}
+}
+
+template <class CharSet>
+static std::string scanBatch( const std::string& doc, std::size_t chunksize, std::size_t batchsize, unsigned short mask)
+{
+	typedef XMLScanner<SrcIterator,CharSet,CharSet,std::string> Scanner;
+	Scanner xs;
+	xs.setZeroCopy();
+	typename Scanner::EventBatch batch;
+	std::ostringstream out;
+	std::string chunk;
+	std::size_t pos = 0;
+	for (;;)
+	{
+		chunk = doc.substr( pos, chunksize);
+		pos += chunk.size();
+		xs.feed( chunk.c_str(), chunk.size(), pos >= doc.size());
+
+		for (;;)
+		{
+			std::size_t nn = xs.nextItems( batch, batchsize, mask);
+			if (nn == 0 || nn > batchsize) throw std::logic_error( "illegal batch size");
+			for (std::size_t ii=0; ii<nn; ++ii)
+			{
+				typename Scanner::ElementType type = batch.type( ii);
+				if (type == Scanner::None) break;
+				if (type != Scanner::Exit) out << batch.position( ii) << " ";
+				out << Scanner::getElementTypeName( type);
+				if ((mask & (1 << type)) != 0) out << " [" << std::string( batch.content( ii), batch.contentSize( ii)) << "]";
+				out << std::endl;
+				if (type == Scanner::ErrorOccurred || type == Scanner::Exit) return out.str();
+			}
+			if (batch.type( nn-1) == Scanner::None) break;
+		}
+	}
+}
+
+template <class CharSet>
+static bool compare( const char* name, const std::string& doc, unsigned short mask)
+{
+	std::string expected = scan<CharwiseIterator,CharSet>( CharwiseIterator( doc.c_str(), doc.size()), false, mask);
+	std::string res_cstring = scan<CStringIterator,CharSet>( CStringIterator( doc), false, mask);
+	std::string res_src = scan<SrcIterator,CharSet>( SrcIterator( doc.c_str(), doc.size()), false, mask);
+	std::string res_charp = scan<char*,CharSet>( const_cast<char*>( doc.c_str()), false, mask);
+	std::string res_cstring_view = scan<CStringIterator,CharSet>( CStringIterator( doc), true, mask);
+	std::string res_src_view = scan<SrcIterator,CharSet>( SrcIterator( doc.c_str(), doc.size()), true, mask);
+	std::string res_charp_view = scan<char*,CharSet>( const_cast<char*>( doc.c_str()), true, mask);
+	std::string res_stream_1 = scanStream<CharSet>( doc, 1, mask);
+	std::string res_stream_7 = scanStream<CharSet>( doc, 7, mask);
+	std::string res_stream_8k = scanStream<CharSet>( doc, 8192, mask);
+	std::string res_chunk_1 = scanChunkwise<CharSet>( doc, 1, mask);
+	std::string res_chunk_5 = scanChunkwise<CharSet>( doc, 5, mask);
+	std::string res_chunk_64 = scanChunkwise<CharSet>( doc, 64, mask);
+	std::string res_batch_1 = scanBatch<CharSet>( doc, doc.size(), 1, mask);
+	std::string res_batch_256 = scanBatch<CharSet>( doc, doc.size(), 256, mask);
+	std::string res_batch_chunk_5 = scanBatch<CharSet>( doc, 5, 3, mask);
+	std::string res_mmap;
+	{
+		static const char* tmpfile = "test_XMLScannerBulk.tmp";
+		{
+			std::ofstream tmp( tmpfile, std::ios::out | std::ios::binary | std::ios::trunc);
+			tmp.write( doc.c_str(), doc.size());
+		}
+		{
+			MMapFile file( tmpfile);
+			res_mmap = scan<MMapIterator,CharSet>( MMapIterator( file), true, mask);
+		}
+		std::remove( tmpfile);
+	}
+	bool nullterm = (doc.size() == std::strlen( doc.c_str()));
+
+	if (expected != res_cstring || expected != res_src || expected != res_cstring_view || expected != res_src_view || expected != res_mmap
+	||  (nullterm && (expected != res_charp || expected != res_charp_view
+		|| expected != res_stream_1 || expected != res_stream_7 || expected != res_stream_8k
+		|| expected != res_chunk_1 || expected != res_chunk_5 || expected != res_chunk_64
+		|| expected != res_batch_1 || expected != res_batch_256 || expected != res_batch_chunk_5)))
+	{
+		std::cerr << "test " << name << " failed:" << std::endl << expected << std::endl << res_cstring << std::endl << res_cstring_view << std::endl << res_stream_7 << std::endl << res_chunk_5 << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// \brief Scan a document with input and output encoding differing, the content is printed in the output encoding as hex bytes
+template <class Iterator, class InCharSet, class OutCharSet>
+static std::string scanTranscoded( const Iterator& src, const InCharSet& charset)
+{
+	typedef XMLScanner<Iterator,InCharSet,OutCharSet,std::string> Scanner;
+	Scanner xs( charset, src);
+	std::ostringstream out;
+	for (;;)
+	{
+		typename Scanner::ElementType type = xs.nextItem();
+		out << Scanner::getElementTypeName( type) << " [";
+		for (std::size_t ii=0; ii<xs.getItemSize(); ++ii) out << std::hex << (unsigned int)(unsigned char)xs.getItemPtr()[ii] << " ";
+		out << "]" << std::endl;
+		if (type == Scanner::ErrorOccurred || type == Scanner::Exit) break;
+	}
+	return out.str();
+}
+
+/// \brief Encode a null terminated UTF-8 document in another encoding
+template <class CharSet>
+static std::string encodeDoc( const std::string& doc, const CharSet& charset)
+{
+	std::string rt;
+	TextScanner<CStringIterator,charset::UTF8> reader( CStringIterator( doc.c_str(), doc.size()));
+	for (; reader.chr(); ++reader) charset.print( reader.chr(), rt);
+	return rt;
+}
+
+/// \brief Compare the scanning of a document with transcoding of runs (bulk) with the scanning character by character
+template <class InCharSet, class OutCharSet>
+static bool compareTranscoded( const char* name, const std::string& utf8doc, const InCharSet& charset=InCharSet())
+{
+	std::string doc = encodeDoc( utf8doc, charset);
+	std::string expected = scanTranscoded<CharwiseIterator,InCharSet,OutCharSet>( CharwiseIterator( doc.c_str(), doc.size()), charset);
+	std::string res_cstring = scanTranscoded<CStringIterator,InCharSet,OutCharSet>( CStringIterator( doc.c_str(), doc.size()), charset);
+	std::string res_src = scanTranscoded<SrcIterator,InCharSet,OutCharSet>( SrcIterator( doc.c_str(), doc.size()), charset);
+	if (expected != res_cstring || expected != res_src)
+	{
+		std::cerr << "test transcoding " << name << " failed:" << std::endl << expected << std::endl << res_cstring << std::endl << res_src << std::endl;
+		return false;
+	}
+	return true;
+}
+
+template <class InCharSet>
+static bool compareTranscoded( const char* name, const std::string& utf8doc, const InCharSet& charset=InCharSet())
+{
+	return compareTranscoded<InCharSet,charset::UTF8>( name, utf8doc, charset)
+		&& compareTranscoded<InCharSet,charset::UTF16LE>( name, utf8doc, charset)
+		&& compareTranscoded<InCharSet,charset::UCS2BE>( name, utf8doc, charset)
+		&& compareTranscoded<InCharSet,charset::UCS4BE>( name, utf8doc, charset)
+		&& compareTranscoded<InCharSet,charset::IsoLatin>( name, utf8doc, charset);
+}
+
+/// \brief Scan a UTF-8 document with malformed characters, the elements are printed up to the first error with its code
+template <class Iterator, class OutCharSet>
+static std::string scanMalformed( const Iterator& src)
+{
+	typedef XMLScanner<Iterator,charset::UTF8,OutCharSet,std::string> Scanner;
+	Scanner xs( src);
+	std::ostringstream out;
+	for (;;)
+	{
+		typename Scanner::ElementType type = xs.nextItem();
+		out << Scanner::getElementTypeName( type);
+		if (type == Scanner::ErrorOccurred) out << " " << Scanner::getErrorString( xs.getError());
+		out << std::endl;
+		if (type == Scanner::ErrorOccurred || type == Scanner::Exit) break;
+	}
+	return out.str();
+}
+
+template <class OutCharSet>
+static bool checkMalformed( const char* name, const std::string& doc, const std::string& expected)
+{
+	std::string res_charwise = scanMalformed<CharwiseIterator,OutCharSet>( CharwiseIterator( doc.c_str(), doc.size()));
+	std::string res_cstring = scanMalformed<CStringIterator,OutCharSet>( CStringIterator( doc.c_str(), doc.size()));
+	std::string res_src = scanMalformed<SrcIterator,OutCharSet>( SrcIterator( doc.c_str(), doc.size()));
+	if (res_charwise != expected || res_cstring != expected || res_src != expected)
+	{
+		std::cerr << "test malformed " << name << " failed:" << std::endl << expected << std::endl << res_charwise << std::endl << res_cstring << std::endl << res_src << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/// \brief Scan a document fed chunkwise in an encoding and skip the subtree of every element, where an item starting with "skip" is returned
+/// \param [in] resume true, if a skip interrupted by the end of a chunk is continued with skipSubtree(), false if with nextItem()
+template <class CharSet>
+static std::string scanSkipping( const std::string& utf8doc, std::size_t chunksize, bool resume, const CharSet& charset=CharSet())
+{
+	typedef XMLScanner<SrcIterator,CharSet,charset::UTF8,std::string> Scanner;
+	std::string doc = encodeDoc( utf8doc, charset);
+	Scanner xs( charset);
+	std::ostringstream out;
+	std::string chunk;
+	std::size_t pos = 0;
+	bool skip = false;
+	for (;;)
+	{
+		chunk = doc.substr( pos, chunksize);
+		pos += chunk.size();
+		xs.feed( chunk.c_str(), chunk.size(), pos >= doc.size());
+
+		typename Scanner::ElementType type;
+		while ((type = skip ? xs.skipSubtree() : xs.nextItem()) != Scanner::None)
+		{
+			std::string item( xs.getItemPtr(), xs.getItemSize());
+			out << Scanner::getElementTypeName( type) << " [" << item << "]" << std::endl;
+			if (type == Scanner::ErrorOccurred || type == Scanner::Exit) return out.str();
+			skip = (item.compare( 0, 4, "skip") == 0);
+		}
+		// ... a skip interrupted by the end of a chunk is continued by nextItem() or by calling skipSubtree() again
+		if (!resume) skip = false;
+	}
+}
+
+int main( int, const char**)
+{
+	static const char* docs[] =
+	{
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n<doc id='1' name=\"a long attribute value with more than thirty two characters\">a content element with more than thirty two characters &amp; an entity</doc>",
+		"<doc>line one\r\nline two\rline three\n\rline four\r\r\n</doc>",
+		"<doc a='single &quot;quoted&quot; value' b=\"double 'quoted' value\">\xC3\xA4\xC3\xB6\xC3\xBC unicode \xE2\x82\xAC euro sign \xF0\x9F\x98\x80 smiley and more text after it</doc>",
+		"<doc>malformed \xC3< utf-8 \xE2\x82 and stray \x80\xBF continuation bytes \xFF\xFE end</doc>",
+		"<doc><![CDATA[ some cdata ]] > text ]]></doc><!-- comment --><x>&#65;&#x42;&lt;&gt;&apos;&nbsp;</x>",
+		"<a><b><c attr='value'/><d>text with\ttabs\tand\x01control\x05chars</d></b></a>",
+		"<doc>unterminated content with trailing text that is long enough to use vector blocks"
+	};
+	typedef XMLScannerBase XB;
+	static const unsigned short masks[] =
+	{
+		0xFFFF,
+		(unsigned short)~((1<<XB::Content)|(1<<XB::TagAttribValue)),
+		(unsigned short)((1<<XB::OpenTag)|(1<<XB::CloseTag))
+	};
+	unsigned int ii = 0, nofdocs = sizeof(docs)/sizeof(docs[0]), nofmasks = sizeof(masks)/sizeof(masks[0]);
+	for (; ii < nofdocs; ++ii)
+	{
+		std::string doc( docs[ ii]);
+		for (std::size_t pi = 0; pi < doc.size(); pi += 7)
+		{
+			// ... shift the document relative to the vector block alignment
+			std::string shifted = std::string( pi, ' ') + doc;
+			for (unsigned int mi = 0; mi < nofmasks; ++mi)
+			{
+				if (!compare<charset::UTF8>( "UTF-8", shifted, masks[ mi])) return 1;
+				if (!compare<charset::IsoLatin>( "IsoLatin", shifted, masks[ mi])) return 1;
+			}
+		}
+	}
+	for (ii=0; ii < nofdocs; ++ii)
+	{
+		// ... runs transcoded in one go between different input and output encodings
+		if (ii == 3) continue; //... malformed UTF-8 has no representation in other encodings
+		std::string doc( docs[ ii]);
+		for (std::size_t pi = 0; pi < 9; pi += 4)
+		{
+			std::string shifted = std::string( pi, ' ') + doc;
+			if (!compareTranscoded<charset::UTF8>( "UTF-8", shifted)) return 1;
+			if (!compareTranscoded<charset::IsoLatin>( "IsoLatin-5", shifted, charset::IsoLatin( 5))) return 1;
+			if (!compareTranscoded<charset::UTF16BE>( "UTF-16BE", shifted)) return 1;
+			if (!compareTranscoded<charset::UTF16LE>( "UTF-16LE", shifted)) return 1;
+			if (!compareTranscoded<charset::UCS2LE>( "UCS-2LE", shifted)) return 1;
+			if (!compareTranscoded<charset::UCS4LE>( "UCS-4LE", shifted)) return 1;
+		}
+	}
+	{
+		// ... skip subtrees from inside an open tag, after an attribute, after content and of empty elements
+		static const char* doc =
+			"<doc><a>x</a><skip id='1' t=\"a>b/c\" u='</skip>'><b>y<c/><c x='>'/></b>"
+			"<!-- <skip> -- - --><![CDATA[ </skip> <x> ]]]><?pi <y> ? ?><!DOCTYPE x><d   /></skip>"
+			"<e>z</e><skip/><skip></skip><f q='1' skipattr='2' r='3'><g/><h>a</h></f>"
+			"<i>skip rest<j>\xC3\xA4\xE2\x82\xAC</j>more</i><k/></doc>";
+		static const char* expected =
+			"OpenTag [doc]\nOpenTag [a]\nContent [x]\nCloseTag [a]\nOpenTag [skip]\nCloseTag []\n"
+			"OpenTag [e]\nContent [z]\nCloseTag [e]\nOpenTag [skip]\nCloseTag []\nOpenTag [skip]\nCloseTag []\n"
+			"OpenTag [f]\nTagAttribName [q]\nTagAttribValue [1]\nTagAttribName [skipattr]\nCloseTag []\n"
+			"OpenTag [i]\nContent [skip rest]\nCloseTag []\nOpenTag [k]\nCloseTagIm []\nCloseTag [doc]\nExit []\n";
+		for (std::size_t chunksize = 1; chunksize <= std::strlen( doc); chunksize = chunksize * 2 + 1)
+		{
+			for (int resume = 0; resume < 2; ++resume)
+			{
+				std::string res_utf8 = scanSkipping<charset::UTF8>( doc, chunksize, resume != 0);
+				std::string res_utf16 = scanSkipping<charset::UTF16LE>( doc, chunksize, resume != 0);
+				std::string res_ucs4 = scanSkipping<charset::UCS4BE>( doc, chunksize, resume != 0);
+				std::string res_latin = scanSkipping<charset::IsoLatin>( doc, chunksize, resume != 0);
+				if (res_utf8 != expected || res_utf16 != expected || res_ucs4 != expected || res_latin != expected)
+				{
+					std::cerr << "test skip subtree failed with chunk size " << chunksize << (resume?" (resumed with skipSubtree)":"") << ":" << std::endl << expected << std::endl << res_utf8 << std::endl << res_utf16 << std::endl << res_ucs4 << std::endl << res_latin << std::endl;
+					return 1;
+				}
+			}
+		}
+		// ... a skip outside of an element is an error
+		typedef XMLScanner<SrcIterator,charset::UTF8,charset::UTF8,std::string> Scanner;
+		static const char* doc2 = "<?xml version='1.0'?><doc/>";
+		Scanner xs( SrcIterator( doc2, std::strlen( doc2)));
+		if (xs.skipSubtree() != Scanner::ErrorOccurred)
+		{
+			std::cerr << "skip outside of an element not rejected" << std::endl;
+			return 1;
+		}
+	}
+	{
+		// ... a default constructed stream iterator is at the end of input like an iterator on an empty stream
+		IStreamIterator empty;
+		if (*empty != 0 || empty.windowBegin() != empty.windowEnd() || *++empty != 0
+		||  scan<IStreamIterator,charset::UTF8>( IStreamIterator()) != scanStream<charset::UTF8>( "", 8, 0xFFFF))
+		{
+			std::cerr << "default constructed stream iterator not at end of input" << std::endl;
+			return 1;
+		}
+	}
+	{
+		// ... elements masked out are returned with empty content, also in a batch
+		static const char* doc = "<a x='attrval'>content<b>more</b></a>";
+		static const char* expected =
+			"OpenTag [a]\nTagAttribName [x]\nTagAttribValue []\nContent []\nOpenTag [b]\nContent []\nCloseTag [b]\nCloseTag [a]\nExit []\n";
+		typedef XMLScanner<char*,charset::UTF8,charset::UTF8,std::string> Scanner;
+		unsigned short mask = (unsigned short)~((1<<XB::Content)|(1<<XB::TagAttribValue));
+		for (std::size_t batchsize = 1; batchsize <= 16; batchsize *= 4)
+		{
+			Scanner xs( const_cast<char*>( doc));
+			Scanner::EventBatch batch;
+			std::ostringstream out, outsingle;
+			std::size_t nn;
+			do
+			{
+				nn = xs.nextItems( batch, batchsize, mask);
+				for (std::size_t bi=0; bi<nn; ++bi)
+				{
+					out << Scanner::getElementTypeName( batch.type( bi)) << " [" << std::string( batch.content( bi), batch.contentSize( bi)) << "]" << std::endl;
+				}
+			}
+			while (batch.type( nn-1) != Scanner::Exit && batch.type( nn-1) != Scanner::ErrorOccurred);
+
+			Scanner xs2( const_cast<char*>( doc));
+			Scanner::ElementType type;
+			do
+			{
+				type = xs2.nextItem( mask);
+				outsingle << Scanner::getElementTypeName( type) << " [" << std::string( xs2.getItemPtr(), xs2.getItemSize()) << "]" << std::endl;
+			}
+			while (type != Scanner::Exit && type != Scanner::ErrorOccurred);
+
+			if (out.str() != expected || outsingle.str() != expected)
+			{
+				std::cerr << "test masked elements failed with batch size " << batchsize << ":" << std::endl << expected << std::endl << out.str() << std::endl << outsingle.str() << std::endl;
+				return 1;
+			}
+		}
+	}
+	{
+		// ... malformed UTF-8 is reported as error and never consumes the markup following it
+		static const char* malformed[] =
+		{
+			"<a>x\xC3</a><b>q</b>",
+			"<a>x\xC0\xAF</a>",
+			"<a>x\xED\xA0\x80</a>",
+			"<a>x\xF8\x88\x80\x80\x80</a>",
+			"<a>a long content with more than thirty two characters before \xE2\x82</a>"
+		};
+		static const char* expected = "OpenTag\nErrorOccurred invalid character\n";
+		for (ii=0; ii < sizeof(malformed)/sizeof(malformed[0]); ++ii)
+		{
+			for (std::size_t pi = 0; pi < 9; pi += 4)
+			{
+				std::string shifted = std::string( pi, ' ') + malformed[ ii];
+				if (!checkMalformed<charset::UTF8>( "UTF-8", shifted, expected)) return 1;
+				if (!checkMalformed<charset::UTF16LE>( "UTF-16LE", shifted, expected)) return 1;
+				if (!checkMalformed<charset::UCS4BE>( "UCS-4BE", shifted, expected)) return 1;
+			}
+		}
+	}
+	{
+		// ... check that content without entities and carriage returns is returned as view on the source
+		static const char* doc = "<doc attr='value'>some content</doc>";
+		typedef XMLScanner<char*,charset::UTF8,charset::UTF8,std::string> Scanner;
+		Scanner xs( const_cast<char*>( doc));
+		xs.setZeroCopy();
+		Scanner::iterator itr = xs.begin(), end = xs.end();
+		for (; itr != end; ++itr)
+		{
+			if (itr->size() && (itr->content() < doc || itr->content() >= doc + std::strlen( doc)))
+			{
+				std::cerr << "element " << itr->name() << " not returned as view on the source" << std::endl;
+				return 1;
+			}
+		}
+	}
+	std::cerr << "OK" << std::endl;
+	return 0;
+}
@@ -0,0 +1,45 @@
+#include "textwolf.hpp"
+#include <iostream>
+
+//build gcc
+//compile: g++ -c -o test_XMLScannerTable.o -g -I../include/ -pedantic -Wall -O4 test_XMLScannerTable.cpp
+//link: g++ -lc -o test_XMLScannerTable test_XMLScannerTable.o
+//build windows
+//compile: cl.exe /wd4996 /Ob2 /O2 /EHsc /MT /W4 /nologo /I..\include /D "WIN32" /D "_WINDOWS" /Fo"test_XMLScannerTable.obj" test_XMLScannerTable.cpp
+//link: link.exe /out:.\test_XMLScannerTable test_XMLScannerTable.obj
+
+using namespace textwolf;
+
+// Checks that the compiled state transition table of the XML scanner is equivalent to the descriptive definition of the state machine
+int main( int, const char**)
+{
+	typedef XMLScannerBase XB;
+	XB::Statemachine stm;
+	const XB::StateTableElement* tab = XB::stateTable();
+
+	for (int si=0; si<XB::NofSTMStates; ++si)
+	{
+		const ScannerStatemachine::Element* ee = stm.get( si);
+		const XB::StateTableElement& te = tab[ si];
+		bool equal = true;
+		for (int ci=0; ci<NofControlCharacter; ++ci)
+		{
+			if (ee->next[ ci] != te.next[ ci]) equal = false;
+		}
+		if (ee->fallbackState != te.fallbackState
+		||  ee->missError != te.missError
+		||  ee->action.op != te.actionOp
+		||  (ee->action.op != -1 && ee->action.arg != te.actionArg)
+		||  ee->nofnext != te.nofnext)
+		{
+			equal = false;
+		}
+		if (!equal)
+		{
+			std::cerr << "state table differs from state machine definition in state " << XB::getStateString( (XB::STMState)si) << std::endl;
+			return 1;
+		}
+	}
+	std::cerr << "OK" << std::endl;
+	return 0;
+}